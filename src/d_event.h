@@ -49,6 +49,9 @@ typedef struct
     int		data3;		// mouse/joystick y move
 } event_t;
 
+// Joystick axes run from -JOYRANGE to JOYRANGE
+#define JOYRANGE	256
+
  
 typedef enum
 {
@@ -60,6 +60,7 @@ static const char rcsid[] = "$Id: d_main.c,v 1.8 1997/02/03 22:45:09 b1 Exp $";
 #include "m_misc.h"
 #include "m_menu.h"
 
+#include "i_prof.h"
 #include "i_system.h"
 #include "i_sound.h"
 #include "i_video.h"
@@ -209,6 +210,11 @@ void D_Display (void)
     if (nodrawers)
 	return;                    // for comparative timing / profiling
 		
+    // the render thread may still be drawing the view
+    PROF_START (prof_viewwait);
+    R_WaitView ();
+    PROF_STOP (prof_viewwait);
+
     redrawsbar = false;
     
     // change the view size if needed
@@ -243,7 +249,9 @@ void D_Display (void)
 	    redrawsbar = true;
 	if (inhelpscreensstate && !inhelpscreens)
 	    redrawsbar = true;              // just put away the help screen
+	PROF_START (prof_statusbar);
 	ST_Drawer (viewheight == 200, redrawsbar );
+	PROF_STOP (prof_statusbar);
 	fullscreen = viewheight == 200;
 	break;
 
@@ -265,7 +273,11 @@ void D_Display (void)
     
     // draw the view directly
     if (gamestate == GS_LEVEL && !automapactive && gametic)
+    {
+	r_ticfrac = g_interpolate && !singletics ? I_GetTicFrac () : FRACUNIT;
 	R_RenderPlayerView (&players[displayplayer]);
+	V_MarkRect (viewwindowx, viewwindowy, scaledviewwidth, viewheight);
+    }
 
     if (gamestate == GS_LEVEL && gametic)
 	HU_Drawer ();
@@ -312,7 +324,9 @@ void D_Display (void)
 
 
     // menus go directly to the screen
+    PROF_START (prof_menu);
     M_Drawer ();          // menu is drawn even on top of everything
+    PROF_STOP (prof_menu);
     NetUpdate ();         // send out any new accumulation
 
 
@@ -334,6 +348,8 @@ void D_Display (void)
 	{
 	    nowtime = I_GetTime ();
 	    tics = nowtime - wipestart;
+	    if (!tics)
+		I_WaitTic ();
 	} while (!tics);
 	wipestart = nowtime;
 	done = wipe_ScreenWipe(wipe_Melt
@@ -353,6 +369,8 @@ extern  boolean         demorecording;
 
 void D_DoomLoop (void)
 {
+    boolean	wiping;
+
     if (demorecording)
 	G_BeginRecording ();
 		
@@ -368,10 +386,14 @@ void D_DoomLoop (void)
 
     while (1)
     {
+	// pace frames under -fps
+	I_WaitFrame ();
+
 	// frame syncronous IO operations
 	I_StartFrame ();                
 	
 	// process one or more tics
+	PROF_START (prof_tics);
 	if (singletics)
 	{
 	    I_StartTic ();
@@ -388,11 +410,24 @@ void D_DoomLoop (void)
 	{
 	    TryRunTics (); // will run at least one tic
 	}
+	PROF_STOP (prof_tics);
 		
 	S_UpdateSounds (players[consoleplayer].mo);// move positional sounds
 
-	// Update display, next frame, with current state.
-	D_Display ();
+	// Update display, next frame, with current state,
+	// unless the game would fall behind under -frameskip.
+	// In a netgame maketic runs ahead by the latency.
+	if (singletics || !I_SkipFrame (netgame ? 0 : maketic - gametic))
+	{
+	    wiping = gamestate != wipegamestate;
+	    D_Display ();
+	    if (!singletics)
+		I_FrameDrawn (!wiping);
+	}
+
+	// -rthread: draw the view of this tic while the next runs
+	if (!nodrawers)
+	    R_StartView ();
 
 #ifndef SNDSERV
 	// Sound mixing for the buffer is snychronous.
@@ -403,6 +438,8 @@ void D_DoomLoop (void)
 	// Update sound output.
 	I_SubmitSound();
 #endif
+
+	I_ProfileEndFrame ();
     }
 }
 
@@ -673,6 +673,11 @@ void TryRunTics (void)
     else
 	counts = availabletics;
     
+    // interpolating, draw another frame instead of waiting
+    // for the next tic
+    if (counts < 1 && !realtics && g_interpolate)
+	return;
+
     if (counts < 1)
 	counts = 1;
 		
@@ -730,6 +735,9 @@ void TryRunTics (void)
 	    M_Ticker ();
 	    return;
 	} 
+
+	// nothing to do before the next tic
+	I_WaitTic ();
     }
     
     // run the count * ticdup dics
@@ -163,6 +163,10 @@ typedef struct player_s
     // True if secret level has been done.
     boolean		didsecret;	
 
+    // View height before the tic, for -interpolate.
+    // Not saved, keep it last.
+    fixed_t		oldviewz;
+
 } player_t;
 
 
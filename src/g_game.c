@@ -200,6 +200,8 @@ int		dclicks2;
 // joystick values are repeated 
 int             joyxmove;
 int		joyymove;
+int		joysidecarry;			// analog move left over
+int		joyforwardcarry;
 boolean         joyarray[5]; 
 boolean*	joybuttons = &joyarray[1];		// allow [-1] 
  
@@ -228,6 +230,28 @@ int G_CmdChecksum (ticcmd_t* cmd)
 } 
  
 
+//
+// G_JoyMove
+// Share of a full move for a joystick axis. What is left below
+// a whole unit carries into the next tic, so slight pushes
+// still move at their speed on average.
+//
+int G_JoyMove (int axis, int full, int* carry)
+{
+    int		move;
+
+    if (!axis)
+    {
+	*carry = 0;
+	return 0;
+    }
+
+    move = axis * full + *carry;
+    *carry = move % JOYRANGE;
+    return move / JOYRANGE;
+}
+
+
 //
 // G_BuildTiccmd
 // Builds a ticcmd from all of the available inputs
@@ -287,10 +311,7 @@ void G_BuildTiccmd (ticcmd_t* cmd)
 	    //	fprintf(stderr, "strafe left\n");
 	    side -= sidemove[speed]; 
 	}
-	if (joyxmove > 0) 
-	    side += sidemove[speed]; 
-	if (joyxmove < 0) 
-	    side -= sidemove[speed]; 
+	side += G_JoyMove (joyxmove, sidemove[speed], &joysidecarry);
  
     } 
     else 
@@ -299,10 +320,7 @@ void G_BuildTiccmd (ticcmd_t* cmd)
 	    cmd->angleturn -= angleturn[tspeed]; 
 	if (gamekeydown[key_left]) 
 	    cmd->angleturn += angleturn[tspeed]; 
-	if (joyxmove > 0) 
-	    cmd->angleturn -= angleturn[tspeed]; 
-	if (joyxmove < 0) 
-	    cmd->angleturn += angleturn[tspeed]; 
+	cmd->angleturn -= joyxmove*angleturn[tspeed]/JOYRANGE; 
     } 
  
     if (gamekeydown[key_up]) 
@@ -315,10 +333,7 @@ void G_BuildTiccmd (ticcmd_t* cmd)
 	// fprintf(stderr, "down\n");
 	forward -= forwardmove[speed]; 
     }
-    if (joyymove < 0) 
-	forward += forwardmove[speed]; 
-    if (joyymove > 0) 
-	forward -= forwardmove[speed]; 
+    forward -= G_JoyMove (joyymove, forwardmove[speed], &joyforwardcarry);
     if (gamekeydown[key_straferight]) 
 	side += sidemove[speed]; 
     if (gamekeydown[key_strafeleft]) 
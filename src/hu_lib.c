@@ -166,6 +166,7 @@ void HUlib_eraseTextLine(hu_textline_t* l)
 		// erase right border
 	    }
 	}
+	V_MarkRect(0, l->y, SCREENWIDTH, lh);
     }
 
     lastautomapactive = automapactive;
@@ -24,6 +24,7 @@ static const char
 rcsid[] = "$Id: hu_stuff.c,v 1.4 1997/02/03 16:47:52 b1 Exp $";
 
 #include <ctype.h>
+#include <stdio.h>
 
 #include "doomdef.h"
 
@@ -36,6 +37,7 @@ rcsid[] = "$Id: hu_stuff.c,v 1.4 1997/02/03 16:47:52 b1 Exp $";
 #include "w_wad.h"
 
 #include "s_sound.h"
+#include "i_sound.h"
 
 #include "doomstat.h"
 
@@ -60,6 +62,10 @@ rcsid[] = "$Id: hu_stuff.c,v 1.4 1997/02/03 16:47:52 b1 Exp $";
 #define HU_INPUTWIDTH	64
 #define HU_INPUTHEIGHT	1
 
+// Audio telemetry with -sndstats, under the chat input
+#define HU_SNDSTATSX	HU_MSGX
+#define HU_SNDSTATSY	(HU_INPUTY + SHORT(hu_font[0]->height) + 1)
+
 
 
 char*	chat_macros[] =
@@ -107,6 +113,10 @@ extern boolean		automapactive;
 
 static boolean		headsupactive = false;
 
+static hu_textline_t	w_sndstats;
+static boolean		sndstats_on;
+static sndstats_t	sndstats_last;
+
 //
 // Builtin map names.
 // The actual names can be found in DStrings.h.
@@ -469,6 +479,13 @@ void HU_Start(void)
     while (*s)
 	HUlib_addCharToTextLine(&w_title, *(s++));
 
+    // create the audio telemetry widget
+    HUlib_initTextLine(&w_sndstats,
+		       HU_SNDSTATSX, HU_SNDSTATSY,
+		       hu_font,
+		       HU_FONTSTART);
+    sndstats_on = I_ReadSoundStats(&sndstats_last);
+
     // create the chat widget
     HUlib_initIText(&w_chat,
 		    HU_INPUTX, HU_INPUTY,
@@ -490,6 +507,8 @@ void HU_Drawer(void)
     HUlib_drawIText(&w_chat);
     if (automapactive)
 	HUlib_drawTextLine(&w_title, false);
+    if (sndstats_on)
+	HUlib_drawTextLine(&w_sndstats, false);
 
 }
 
@@ -499,15 +518,59 @@ void HU_Erase(void)
     HUlib_eraseSText(&w_message);
     HUlib_eraseIText(&w_chat);
     HUlib_eraseTextLine(&w_title);
+    HUlib_eraseTextLine(&w_sndstats);
 
 }
 
+//
+// Audio over the last second: underruns, wakeups a sample
+//  period or more late, mixing and device write times in
+//  microseconds, average/peak, and the voices playing.
+//
+static void HU_UpdateSoundStats(void)
+{
+    sndstats_t	now;
+    char	buf[HU_MAXLINELENGTH];
+    char*	s;
+    long long	blocks;
+    long long	samples;
+    int		late;
+    int		i;
+
+    if (!I_ReadSoundStats(&now))
+	return;
+
+    late = 0;
+    for (i=3 ; i<SNDLATEBINS ; i++)
+	late += now.late[i] - sndstats_last.late[i];
+
+    blocks = now.mixBlocks - sndstats_last.mixBlocks;
+    samples = now.samples - sndstats_last.samples;
+
+    snprintf(buf, sizeof(buf), "SND UNDR %d LATE %d MIX %d/%d OUT %d/%d V %d+%d",
+	     now.underruns - sndstats_last.underruns, late,
+	     blocks ? (int)((now.mixNanos - sndstats_last.mixNanos) / (blocks*1000)) : 0,
+	     now.mixPeakNanos / 1000,
+	     samples ? (int)((now.writeNanos - sndstats_last.writeNanos) / (samples*1000)) : 0,
+	     now.writePeakNanos / 1000,
+	     now.voices, now.musicVoices);
+
+    HUlib_clearTextLine(&w_sndstats);
+    for (s=buf ; *s ; s++)
+	HUlib_addCharToTextLine(&w_sndstats, *s);
+
+    sndstats_last = now;
+}
+
 void HU_Ticker(void)
 {
 
     int i, rc;
     char c;
 
+    if (sndstats_on && !(gametic % TICRATE))
+	HU_UpdateSoundStats();
+
     // tick down message counter if message is up
     if (message_counter && !--message_counter)
     {
@@ -0,0 +1,177 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Video device without a display, for profiling on a build host.
+//	Takes frames as fast as they come and optionally writes them
+//	to PPM files or one raw RGB stream.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "i_system.h"
+#include "i_viddev.h"
+#include "m_argv.h"
+#include "v_video.h"
+
+
+static byte g_palette[256 * 3];
+
+// -framedump <name>: name.raw appends all frames as 24-bit RGB
+// to one file, anything else writes name00000.ppm, name00001.ppm, ...
+static char* g_dumpName = NULL;
+static FILE* g_rawFile = NULL;
+
+static int g_frames = 0;
+static int g_pixels = 0;
+static double g_startTime;
+
+static double HL_Now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec + (double)t.tv_nsec / 1.0e9;
+}
+
+static void HL_WriteRGB(FILE* f, byte* frame)
+{
+	byte line[SCREENWIDTH * 3];
+	int x, y;
+
+	for (y = 0; y < SCREENHEIGHT; y++)
+	{
+		byte* d = line;
+		for (x = 0; x < SCREENWIDTH; x++)
+		{
+			byte* c = g_palette + *frame++ * 3;
+			*d++ = c[0];
+			*d++ = c[1];
+			*d++ = c[2];
+		}
+		fwrite(line, 1, sizeof(line), f);
+	}
+}
+
+void HL_Init(void)
+{
+	int p = M_CheckParm("-framedump");
+	if (p && p < myargc - 1)
+	{
+		int len;
+
+		g_dumpName = myargv[p + 1];
+		len = strlen(g_dumpName);
+		if (len > 4 && !strcasecmp(g_dumpName + len - 4, ".raw"))
+		{
+			g_rawFile = fopen(g_dumpName, "wb");
+			if (!g_rawFile)
+				I_Error("Cannot create frame dump %s", g_dumpName);
+		}
+		else
+		{
+			// The first frame, so a bad directory fails here and
+			// not on the display thread
+			char name[256];
+			FILE* f;
+
+			snprintf(name, sizeof(name), "%s%05d.ppm", g_dumpName, 0);
+			f = fopen(name, "wb");
+			if (!f)
+				I_Error("Cannot create frame dump %s", name);
+			fclose(f);
+		}
+	}
+
+	g_startTime = HL_Now();
+}
+
+void HL_Shutdown(void)
+{
+	double time = HL_Now() - g_startTime;
+
+	if (g_rawFile)
+	{
+		fclose(g_rawFile);
+		g_rawFile = NULL;
+	}
+
+	fprintf(stderr, "headless: %d frames in %.2f s, %.1f fps, %.0f pixels per frame sent\n",
+			g_frames, time, time > 0 ? g_frames / time : 0.0,
+			g_frames ? (double) g_pixels / g_frames : 0.0);
+}
+
+void HL_SetPalette(byte* palette)
+{
+	memcpy(g_palette, palette, sizeof(g_palette));
+}
+
+void HL_StartUpdate(void)
+{
+}
+
+void HL_WriteRect(byte* frame, const dirtyrect_t* r)
+{
+	g_pixels += (r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+void HL_FinishUpdate(byte* frame)
+{
+	if (g_rawFile)
+	{
+		HL_WriteRGB(g_rawFile, frame);
+	}
+	else if (g_dumpName)
+	{
+		char name[256];
+		FILE* f;
+
+		snprintf(name, sizeof(name), "%s%05d.ppm", g_dumpName, g_frames);
+		f = fopen(name, "wb");
+		if (f)
+		{
+			fprintf(f, "P6\n%d %d\n255\n", SCREENWIDTH, SCREENHEIGHT);
+			HL_WriteRGB(f, frame);
+			if (fclose(f))
+				f = NULL;
+		}
+
+		if (!f)
+		{
+			// Likely the disk is full, stop dumping
+			I_DisplayError("Cannot write frame dump %s", name);
+			g_dumpName = NULL;
+		}
+	}
+
+	g_frames++;
+}
+
+videodev_t headlessvideodev =
+{
+	"headless",
+	HL_Init,
+	HL_Shutdown,
+	HL_SetPalette,
+	HL_StartUpdate,
+	HL_WriteRect,
+	HL_FinishUpdate
+};
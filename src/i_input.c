@@ -0,0 +1,676 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Gamepad input. Any evdev device with X and Y axes and one of
+//	the mapped buttons is a gamepad, -gamepad <device> forces one.
+//	A thread blocks in epoll on the gamepads and on inotify for
+//	/dev/input, so pads can come and go, and keeps the state of
+//	the buttons and axes. The game turns it into an event once a
+//	tic, so input arriving while the game thread is busy, in
+//	I_FinishUpdate say, is not late by a frame.
+//	Axes are scaled to +-JOYRANGE from the range the device
+//	reports, or the calibration saved in the defaults, through a
+//	deadzone and a response curve.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <math.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <linux/input.h>
+
+// Undef name collisions between input.h and doomdef.h
+#undef KEY_ENTER
+#undef KEY_TAB
+#undef KEY_F1
+#undef KEY_F2
+#undef KEY_F3
+#undef KEY_F4
+#undef KEY_F5
+#undef KEY_F6
+#undef KEY_F7
+#undef KEY_F8
+#undef KEY_F9
+#undef KEY_F10
+#undef KEY_F11
+#undef KEY_F12
+#undef KEY_BACKSPACE
+#undef KEY_PAUSE
+#undef KEY_EQUALS
+#undef KEY_MINUS
+
+#include "doomdef.h"
+#include "m_argv.h"
+#include "d_main.h"
+#include "i_prof.h"
+#include "i_input.h"
+
+
+// Older kernel headers name the event time directly
+#ifndef input_event_sec
+#define input_event_sec		time.tv_sec
+#define input_event_usec	time.tv_usec
+#endif
+
+#define INPUTDIR		"/dev/input"
+
+// Gamepads open at once, their events are merged
+#define MAXINPUTS		4
+
+// epoll tags besides the gamepad slots
+#define NOTIFYSLOT		MAXINPUTS
+#define WAKESLOT		(MAXINPUTS+1)
+
+#define BITSPERLONG		(8 * sizeof(long))
+#define NUMLONGS(n)		(((n) + BITSPERLONG - 1) / BITSPERLONG)
+#define TESTBIT(a, n)	(((a)[(n) / BITSPERLONG] >> ((n) % BITSPERLONG)) & 1)
+
+
+typedef struct
+{
+	int		fd;
+	char		name[16];	// event<n> in INPUTDIR
+
+	// X and Y as reported by the device
+	int		min[2];
+	int		center[2];
+	int		max[2];
+
+} inputdev_t;
+
+
+// ev_joystick data1 bits, in order
+static const int	g_buttonCodes[] = { BTN_B, BTN_C, BTN_A, BTN_X };
+#define NUMBUTTONS	(sizeof(g_buttonCodes) / sizeof(g_buttonCodes[0]))
+
+static inputdev_t	g_inputs[MAXINPUTS];
+
+static int		g_epoll = -1;
+static int		g_notify = -1;
+static int		g_wake = -1;
+
+static pthread_t	g_inputThread;
+static boolean		g_inputRunning;
+static volatile boolean	g_inputQuit;
+
+// -gamepad, the only device to use
+static char*		g_gamepadName;
+
+// -joycalibrate, learn joyrange from the stick movements
+static boolean		g_calibrate;
+
+// Saved in the defaults. Deadzone in percent of the way from
+//  the center to the edge, curve the exponent of the response
+//  in tenths, 10 is linear.
+int			joydeadzone = 15;
+int			joycurve = 20;
+
+// Calibrated X and Y min, center and max, all 0 for the range
+//  the device reports
+int			joyrange[2][3];
+
+// Gamepad state, written by the input thread
+static pthread_mutex_t	g_inputLock = PTHREAD_MUTEX_INITIALIZER;
+static int		g_buttons;	// Held down
+static int		g_pressed;	// Went down since the last tic
+static int		g_axis[2];	// +-JOYRANGE
+static int		g_pushed[2];	// Furthest off center since the last tic
+static boolean		g_changed;
+static long long	g_changeNanos;	// First change not posted yet
+static long long	g_lastNanos;	// Latest change
+
+// -profile: time from the kernel event to the tic taking it
+static int		g_latencyCount;
+static long long	g_latencyNanos;
+static long long	g_latencyMax;
+
+
+static long long I_InputNanos(void)
+{
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+
+//
+// Something changed at the time of the event, in nanoseconds.
+//
+static void I_InputChanged(long long nanos)
+{
+	if (!g_changed)
+		g_changeNanos = nanos;
+	g_lastNanos = nanos;
+	g_changed = true;
+}
+
+static void I_SetAxis(int axis, int value, long long nanos)
+{
+	if (value == g_axis[axis])
+		return;
+
+	g_axis[axis] = value;
+	if (abs(value) > abs(g_pushed[axis]))
+		g_pushed[axis] = value;
+	I_InputChanged(nanos);
+}
+
+//
+// A raw axis value of a device to +-JOYRANGE.
+//
+static void I_ReadAxis(inputdev_t* dev, int axis, int value, long long nanos)
+{
+	int*	range = joyrange[axis];
+	int	min;
+	int	center;
+	int	max;
+	double	x;
+	double	dead;
+
+	if (g_calibrate)
+	{
+		if (value < range[0])
+			range[0] = value;
+		if (value > range[2])
+			range[2] = value;
+	}
+
+	if (range[0] < range[1] && range[1] < range[2])
+	{
+		min = range[0];
+		center = range[1];
+		max = range[2];
+	}
+	else
+	{
+		min = dev->min[axis];
+		center = dev->center[axis];
+		max = dev->max[axis];
+	}
+
+	// -1 to 1 on either side of the center
+	if (value < center)
+		x = center > min ? (double)(value - center) / (center - min) : 0;
+	else
+		x = max > center ? (double)(value - center) / (max - center) : 0;
+	if (x < -1)
+		x = -1;
+	if (x > 1)
+		x = 1;
+
+	// Nothing in the deadzone, the full range after it
+	dead = joydeadzone / 100.0;
+	if (fabs(x) <= dead || dead >= 1)
+		x = 0;
+	else
+		x = (x < 0 ? -1 : 1) * pow((fabs(x) - dead) / (1 - dead), joycurve / 10.0);
+
+	I_SetAxis(axis, (int)(x * JOYRANGE), nanos);
+}
+
+static void I_SetButton(int code, int down, long long nanos)
+{
+	int	bit;
+	int	i;
+
+	for (i = 0; i < NUMBUTTONS; i++)
+	{
+		if (g_buttonCodes[i] != code)
+			continue;
+
+		bit = 1 << i;
+		if (!!(g_buttons & bit) == !!down)
+			return;
+
+		if (down)
+		{
+			g_buttons |= bit;
+			g_pressed |= bit;
+		}
+		else
+			g_buttons &= ~bit;
+
+		I_InputChanged(nanos);
+		return;
+	}
+}
+
+
+//
+// Reads the whole state of a device, when it is opened and
+//  after the kernel dropped events. Called with the lock.
+//
+static void I_SyncInput(inputdev_t* dev)
+{
+	unsigned long		keys[NUMLONGS(KEY_MAX+1)];
+	struct input_absinfo	info;
+	long long		nanos = I_InputNanos();
+	int			i;
+
+	memset(keys, 0, sizeof(keys));
+	if (ioctl(dev->fd, EVIOCGKEY(sizeof(keys)), keys) >= 0)
+	{
+		for (i = 0; i < NUMBUTTONS; i++)
+			I_SetButton(g_buttonCodes[i], TESTBIT(keys, g_buttonCodes[i]), nanos);
+	}
+
+	for (i = 0; i < 2; i++)
+	{
+		if (ioctl(dev->fd, EVIOCGABS(i == 0 ? ABS_X : ABS_Y), &info) >= 0)
+			I_ReadAxis(dev, i, info.value, nanos);
+	}
+}
+
+//
+// The range of the axes. Calibrating, the stick is taken to be
+//  centered when the pad shows up.
+//
+static void I_ReadRange(inputdev_t* dev)
+{
+	struct input_absinfo	info;
+	int			i;
+
+	for (i = 0; i < 2; i++)
+	{
+		// Without the range, the thresholds of the original pad
+		dev->min[i] = 0;
+		dev->center[i] = 125;
+		dev->max[i] = 255;
+
+		if (ioctl(dev->fd, EVIOCGABS(i == 0 ? ABS_X : ABS_Y), &info) >= 0
+			&& info.minimum < info.maximum)
+		{
+			dev->min[i] = info.minimum;
+			dev->max[i] = info.maximum;
+			dev->center[i] = (info.minimum + info.maximum + 1) / 2;
+
+			if (g_calibrate)
+				joyrange[i][0] = joyrange[i][1] = joyrange[i][2] = info.value;
+		}
+	}
+}
+
+
+//
+// X and Y axes and at least one of the mapped buttons. Leaves
+//  out keyboards, mice and touchscreens.
+//
+static boolean I_IsGamepad(int fd)
+{
+	unsigned long	keys[NUMLONGS(KEY_MAX+1)];
+	unsigned long	axes[NUMLONGS(ABS_MAX+1)];
+	int		i;
+
+	memset(keys, 0, sizeof(keys));
+	memset(axes, 0, sizeof(axes));
+	if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0
+		|| ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(axes)), axes) < 0)
+		return false;
+
+	if (!TESTBIT(axes, ABS_X) || !TESTBIT(axes, ABS_Y))
+		return false;
+
+	for (i = 0; i < NUMBUTTONS; i++)
+	{
+		if (TESTBIT(keys, g_buttonCodes[i]))
+			return true;
+	}
+
+	return false;
+}
+
+
+//
+// Opens INPUTDIR/name if it is a gamepad and not open yet.
+//  Nodes show up before their permissions are set, inotify
+//  reports both and this is tried again.
+//
+static void I_OpenInput(char* name)
+{
+	struct epoll_event	ev;
+	char			path[64];
+	int			clock = CLOCK_MONOTONIC;
+	int			slot = -1;
+	int			fd;
+	int			i;
+
+	if (strncmp(name, "event", 5) || strlen(name) >= sizeof(g_inputs[0].name))
+		return;
+
+	for (i = 0; i < MAXINPUTS; i++)
+	{
+		if (g_inputs[i].fd >= 0 && !strcmp(g_inputs[i].name, name))
+			return;
+		if (g_inputs[i].fd < 0 && slot < 0)
+			slot = i;
+	}
+	if (slot < 0)
+		return;
+
+	snprintf(path, sizeof(path), INPUTDIR "/%s", name);
+	if (g_gamepadName && strcmp(path, g_gamepadName))
+		return;
+
+	fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0)
+		return;
+
+	if (!g_gamepadName && !I_IsGamepad(fd))
+	{
+		close(fd);
+		return;
+	}
+
+	// Event times on the clock of I_InputNanos
+	ioctl(fd, EVIOCSCLOCKID, &clock);
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = slot;
+	if (epoll_ctl(g_epoll, EPOLL_CTL_ADD, fd, &ev) < 0)
+	{
+		close(fd);
+		return;
+	}
+
+	g_inputs[slot].fd = fd;
+	strcpy(g_inputs[slot].name, name);
+
+	pthread_mutex_lock(&g_inputLock);
+	I_ReadRange(&g_inputs[slot]);
+	I_SyncInput(&g_inputs[slot]);
+	pthread_mutex_unlock(&g_inputLock);
+
+	fprintf(stderr, "I_InitInput: gamepad %s\n", path);
+}
+
+//
+// The device is gone, let go of its buttons and axes.
+//
+static void I_CloseInput(int slot)
+{
+	long long	nanos = I_InputNanos();
+	int		i;
+
+	fprintf(stderr, "I_InitInput: gamepad %s/%s removed\n", INPUTDIR, g_inputs[slot].name);
+
+	epoll_ctl(g_epoll, EPOLL_CTL_DEL, g_inputs[slot].fd, NULL);
+	close(g_inputs[slot].fd);
+	g_inputs[slot].fd = -1;
+
+	pthread_mutex_lock(&g_inputLock);
+	for (i = 0; i < NUMBUTTONS; i++)
+		I_SetButton(g_buttonCodes[i], 0, nanos);
+	I_SetAxis(0, 0, nanos);
+	I_SetAxis(1, 0, nanos);
+	pthread_mutex_unlock(&g_inputLock);
+}
+
+
+//
+// Takes all pending events of a gamepad.
+//
+static void I_ReadInput(int slot)
+{
+	struct input_event	ev[64];
+	struct input_event*	e;
+	inputdev_t*		dev = &g_inputs[slot];
+	long long		nanos;
+	int			fd = dev->fd;
+	int			rd;
+	int			i;
+
+	while ((rd = read(fd, ev, sizeof(ev))) >= (int)sizeof(struct input_event))
+	{
+		pthread_mutex_lock(&g_inputLock);
+		for (i = 0; i < rd / (int)sizeof(struct input_event); i++)
+		{
+			e = &ev[i];
+			nanos = e->input_event_sec * 1000000000LL + e->input_event_usec * 1000LL;
+
+			switch (e->type)
+			{
+			case EV_ABS:
+				if (e->code == ABS_X)
+					I_ReadAxis(dev, 0, e->value, nanos);
+				else if (e->code == ABS_Y)
+					I_ReadAxis(dev, 1, e->value, nanos);
+				break;
+
+			case EV_KEY:
+				I_SetButton(e->code, e->value, nanos);
+				break;
+
+			case EV_SYN:
+				// The kernel queue overflowed, start over
+				//  from the current state
+				if (e->code == SYN_DROPPED)
+					I_SyncInput(dev);
+				break;
+			}
+		}
+		pthread_mutex_unlock(&g_inputLock);
+	}
+
+	if (rd == 0 || (rd < 0 && errno != EAGAIN && errno != EINTR))
+		I_CloseInput(slot);
+}
+
+//
+// New or changed nodes in INPUTDIR.
+//
+static void I_ReadNotify(void)
+{
+	char			buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event*	e;
+	int			rd;
+	int			i;
+
+	while ((rd = read(g_notify, buf, sizeof(buf))) > 0)
+	{
+		for (i = 0; i < rd; i += sizeof(struct inotify_event) + e->len)
+		{
+			e = (struct inotify_event*)&buf[i];
+			if (e->len)
+				I_OpenInput(e->name);
+		}
+	}
+}
+
+
+static void* I_InputThread(void* arg)
+{
+	struct epoll_event	ev[MAXINPUTS+2];
+	int			n;
+	int			i;
+
+	while (!g_inputQuit)
+	{
+		n = epoll_wait(g_epoll, ev, MAXINPUTS+2, -1);
+
+		for (i = 0; i < n; i++)
+		{
+			if (ev[i].data.u32 == NOTIFYSLOT)
+				I_ReadNotify();
+			else if (ev[i].data.u32 < MAXINPUTS && g_inputs[ev[i].data.u32].fd >= 0)
+				I_ReadInput(ev[i].data.u32);
+		}
+	}
+
+	return 0;
+}
+
+
+void I_InitInput(void)
+{
+	struct epoll_event	ev;
+	struct dirent*		entry;
+	DIR*			dir;
+	int			p;
+	int			i;
+	int			err;
+
+	for (i = 0; i < MAXINPUTS; i++)
+		g_inputs[i].fd = -1;
+
+	p = M_CheckParm("-gamepad");
+	if (p && p < myargc-1)
+		g_gamepadName = myargv[p+1];
+
+	if (joydeadzone < 0 || joydeadzone > 90)
+		joydeadzone = 15;
+	if (joycurve < 5 || joycurve > 50)
+		joycurve = 20;
+
+	g_calibrate = M_CheckParm("-joycalibrate") != 0;
+	if (g_calibrate)
+		fprintf(stderr, "I_InitInput: calibrating, move the stick to its edges\n");
+
+	g_epoll = epoll_create1(EPOLL_CLOEXEC);
+	g_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (g_epoll < 0 || g_wake < 0)
+	{
+		fprintf(stderr, "I_InitInput: no epoll, no gamepad: %s\n", strerror(errno));
+		return;
+	}
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = WAKESLOT;
+	epoll_ctl(g_epoll, EPOLL_CTL_ADD, g_wake, &ev);
+
+	// Watch before looking, a pad plugged in meanwhile shows in either
+	g_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (g_notify >= 0 && inotify_add_watch(g_notify, INPUTDIR, IN_CREATE | IN_ATTRIB) >= 0)
+	{
+		ev.events = EPOLLIN;
+		ev.data.u32 = NOTIFYSLOT;
+		epoll_ctl(g_epoll, EPOLL_CTL_ADD, g_notify, &ev);
+	}
+	else
+		fprintf(stderr, "I_InitInput: no hotplug on %s: %s\n", INPUTDIR, strerror(errno));
+
+	dir = opendir(INPUTDIR);
+	if (dir)
+	{
+		while ((entry = readdir(dir)) != NULL)
+			I_OpenInput(entry->d_name);
+		closedir(dir);
+	}
+
+	for (i = 0; i < MAXINPUTS && g_inputs[i].fd < 0; i++);
+	if (i == MAXINPUTS)
+		fprintf(stderr, "I_InitInput: no gamepad yet\n");
+
+	err = pthread_create(&g_inputThread, NULL, &I_InputThread, NULL);
+	if (err != 0)
+		fprintf(stderr, "I_InitInput: can't create input thread: %s\n", strerror(err));
+	g_inputRunning = !err;
+}
+
+
+void I_ShutdownInput(void)
+{
+	unsigned long long	one = 1;
+	int			i;
+
+	if (g_inputRunning)
+	{
+		g_inputQuit = true;
+		if (write(g_wake, &one, sizeof(one)) == sizeof(one))
+			pthread_join(g_inputThread, NULL);
+		g_inputRunning = false;
+	}
+
+	for (i = 0; i < MAXINPUTS; i++)
+	{
+		if (g_inputs[i].fd >= 0)
+			close(g_inputs[i].fd);
+		g_inputs[i].fd = -1;
+	}
+	if (g_notify >= 0)
+		close(g_notify);
+	if (g_wake >= 0)
+		close(g_wake);
+	if (g_epoll >= 0)
+		close(g_epoll);
+	g_notify = g_wake = g_epoll = -1;
+
+	if (g_profiling && g_latencyCount)
+	{
+		fprintf(stderr, "I_ShutdownInput: %d gamepad events, input to tic avg %.2f ms, max %.2f ms\n",
+				g_latencyCount, g_latencyNanos / 1e6 / g_latencyCount, g_latencyMax / 1e6);
+	}
+}
+
+
+void I_PostInput(void)
+{
+	event_t		event;
+	long long	stamp;
+	long long	nanos;
+
+	if (!g_inputRunning)
+		return;
+
+	pthread_mutex_lock(&g_inputLock);
+
+	if (!g_changed)
+	{
+		pthread_mutex_unlock(&g_inputLock);
+		return;
+	}
+
+	// Presses and pushes shorter than a tic count once
+	event.type = ev_joystick;
+	event.data1 = g_buttons | g_pressed;
+	event.data2 = g_axis[0] ? g_axis[0] : g_pushed[0];
+	event.data3 = g_axis[1] ? g_axis[1] : g_pushed[1];
+	stamp = g_changeNanos;
+
+	g_pressed = 0;
+	g_pushed[0] = g_pushed[1] = 0;
+
+	// The state they ended in goes out next tic
+	g_changed = event.data1 != g_buttons || event.data2 != g_axis[0] || event.data3 != g_axis[1];
+	g_changeNanos = g_lastNanos;
+
+	pthread_mutex_unlock(&g_inputLock);
+
+	D_PostEvent(&event);
+
+	if (g_profiling)
+	{
+		nanos = I_InputNanos() - stamp;
+		g_latencyCount++;
+		g_latencyNanos += nanos;
+		if (nanos > g_latencyMax)
+			g_latencyMax = nanos;
+	}
+}
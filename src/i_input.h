@@ -0,0 +1,50 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Gamepad input. A thread waits on the evdev devices and on
+//	/dev/input for hotplug, the game takes the state once a tic.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __I_INPUT__
+#define __I_INPUT__
+
+
+#include "doomtype.h"
+
+
+// Finds the gamepads and starts the input thread.
+void I_InitInput(void);
+
+// Stops the thread, prints the input latency with -profile.
+void I_ShutdownInput(void);
+
+//
+// Posts one ev_joystick event when the gamepad changed since
+//  the last call. Buttons pressed and released in between
+//  still show once. Called every tic.
+//
+void I_PostInput(void);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
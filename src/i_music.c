@@ -0,0 +1,1043 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	MUS music through a small wavetable synth.
+//
+//	I_RegisterSong turns the MUS lump into a timeline of events
+//	at sample positions. The mixer then renders the song in
+//	batches between events, each voice a wavetable oscillator
+//	with a linear envelope, so the per sample work is a table
+//	read and two multiply-adds per voice.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "z_zone.h"
+#include "m_argv.h"
+#include "m_swap.h"
+#include "i_system.h"
+#include "i_snddev.h"
+#include "i_sound.h"
+#include "i_music.h"
+
+
+#define MUSRATE			140	// MUS ticks per second
+#define MUSCHANNELS		16
+#define MUSPERCUSSION		15	// Channel of the drums
+
+#define MAXMUSVOICES		32
+
+// Samples rendered at most between envelope updates
+#define MUSBATCH		32
+
+// Mix level of a voice at full volume, a sound effect is 32
+//  times louder
+#define VOICEPEAK		1024
+
+#define ENVMAX			65536
+
+
+// MUS events, as in the lump
+enum
+{
+	mus_releasenote,
+	mus_playnote,
+	mus_pitchwheel,
+	mus_system,
+	mus_controller,
+	mus_measureend,
+	mus_scoreend,
+	mus_unused
+};
+
+// Controllers and system events that are played
+enum
+{
+	musctrl_instrument = 0,
+	musctrl_volume = 3,
+	musctrl_pan = 4,
+	musctrl_expression = 5,
+	mussys_soundsoff = 10,
+	mussys_notesoff = 11,
+	mussys_resetctrls = 14
+};
+
+
+//
+// An event of the timeline, with the note velocity resolved.
+//
+typedef struct
+{
+	int		sample;		// From the start of the song
+	byte		event;
+	byte		channel;
+	byte		data1;
+	byte		data2;
+
+} musevent_t;
+
+
+typedef enum
+{
+	wave_sine,
+	wave_triangle,
+	wave_saw,
+	wave_square,
+	wave_pulse,
+	wave_organ,
+	wave_noise,
+	NUMWAVES
+
+} muswave_t;
+
+
+//
+// Sound of a General MIDI instrument family, times in ms and
+//  the sustain level out of 256.
+//
+typedef struct
+{
+	muswave_t	wave;
+	int		attack;
+	int		decay;
+	int		sustain;
+	int		release;
+
+} musinstr_t;
+
+static const musinstr_t g_families[16] =
+{
+	{ wave_organ,	  5, 1500,   0, 150 },	// Piano
+	{ wave_sine,	  2,  800,   0, 200 },	// Chromatic percussion
+	{ wave_organ,	 10,    0, 256,  80 },	// Organ
+	{ wave_square,	  5, 1200, 160, 150 },	// Guitar
+	{ wave_triangle,  5,  600, 128, 100 },	// Bass
+	{ wave_saw,	 60,    0, 256, 250 },	// Strings
+	{ wave_saw,	 80,    0, 256, 300 },	// Ensemble
+	{ wave_square,	 30,  200, 192, 150 },	// Brass
+	{ wave_pulse,	 20,  100, 200, 100 },	// Reed
+	{ wave_sine,	 30,    0, 256, 150 },	// Pipe
+	{ wave_square,	  5,  100, 200, 100 },	// Synth lead
+	{ wave_triangle,150,    0, 256, 400 },	// Synth pad
+	{ wave_saw,	 50,  500, 128, 300 },	// Synth effects
+	{ wave_pulse,	  5,  700,   0, 150 },	// Ethnic
+	{ wave_triangle,  2,  300,   0, 100 },	// Percussive
+	{ wave_noise,	 10,  500,   0, 200 }	// Sound effects
+};
+
+
+typedef enum
+{
+	env_attack,
+	env_decay,
+	env_sustain,
+	env_release
+
+} musenv_t;
+
+typedef struct
+{
+	boolean		active;
+	int		channel;
+	int		note;
+	int		velocity;
+
+	short*		wave;		// NULL for noise
+	unsigned	phase;
+	unsigned	step;		// Phase per sample, before the bend
+	boolean		bends;		// Drums keep their pitch
+
+	musenv_t	stage;
+	int		env;		// 0 - ENVMAX
+	int		attackrate;	// Per sample
+	int		decayrate;
+	int		sustain;
+	int		releaserate;
+
+	int		left;		// 0 - VOICEPEAK
+	int		right;
+
+} musvoice_t;
+
+
+typedef struct
+{
+	int		instrument;
+	int		volume;
+	int		pan;
+	int		expression;
+	int		bend;
+
+} muschannel_t;
+
+
+static short		g_waves[NUMWAVES][256];
+
+// Phase steps of the MIDI notes and pitch wheel factors in 16.16
+static unsigned		g_notesteps[128];
+static int		g_bendfactors[256];
+
+// The registered song
+static musevent_t*	g_events;
+static int		g_numEvents;
+
+// Playback, shared by the game thread and the mixer
+static pthread_mutex_t	g_musLock = PTHREAD_MUTEX_INITIALIZER;
+static boolean		g_playing;
+static boolean		g_paused;
+static boolean		g_looping;
+static int		g_event;	// Next event to play
+static int		g_position;	// Samples into the song
+static int		g_musVolume = 8;	// 0 - 15
+
+static musvoice_t	g_voices[MAXMUSVOICES];
+static muschannel_t	g_channels[MUSCHANNELS];
+
+// -musvoices, and the part of it the budget allows now
+static int		g_maxVoices = 16;
+static int		g_voiceCap = 16;
+
+// -musbudget, percent of the real time the synth may take
+static int		g_budget = 15;
+
+// Rendering time, reported at shutdown
+static long long	g_musNanos;
+static long long	g_musSamples;
+static long long	g_musVoiceSamples;
+
+
+//
+// Build the tables.
+//
+void I_InitMusic(void)
+{
+	double	x;
+	int	p;
+	int	i;
+
+	for (i = 0; i < 256; i++)
+	{
+		x = i * 2 * M_PI / 256;
+		g_waves[wave_sine][i] = 32767 * sin(x);
+		g_waves[wave_triangle][i] = i < 128 ? -32767 + i * 511 : 32767 - (i - 128) * 511;
+		g_waves[wave_saw][i] = (i - 128) * 200;
+		g_waves[wave_square][i] = i < 128 ? 20000 : -20000;
+		g_waves[wave_pulse][i] = i < 64 ? 20000 : -20000;
+		g_waves[wave_organ][i] = 32767 * (sin(x) + sin(2*x) / 2 + sin(4*x) / 4) / 1.6;
+	}
+
+	for (i = 0; i < 128; i++)
+		g_notesteps[i] = 440.0 * pow(2.0, (i - 69) / 12.0) * 4294967296.0 / SAMPLERATE;
+
+	// 64 a semitone
+	for (i = 0; i < 256; i++)
+		g_bendfactors[i] = pow(2.0, (i - 128) / (64.0 * 12.0)) * 65536.0;
+
+	p = M_CheckParm("-musvoices");
+	if (p && p < myargc-1)
+	{
+		g_maxVoices = atoi(myargv[p+1]);
+		if (g_maxVoices < 1)
+			g_maxVoices = 1;
+		if (g_maxVoices > MAXMUSVOICES)
+			g_maxVoices = MAXMUSVOICES;
+	}
+	g_voiceCap = g_maxVoices;
+
+	p = M_CheckParm("-musbudget");
+	if (p && p < myargc-1)
+		g_budget = atoi(myargv[p+1]);
+}
+
+
+void I_ShutdownMusic(void)
+{
+	I_UnRegisterSong(1);
+
+	if (g_musSamples)
+	{
+		fprintf(stderr, "I_ShutdownMusic: %.1f ns per sample, %.1f voices on average, "
+				"%d of %d voices at the end\n",
+				(double)g_musNanos / g_musSamples,
+				(double)g_musVoiceSamples / g_musSamples,
+				g_voiceCap, g_maxVoices);
+	}
+}
+
+
+//
+// Parse a MUS score into events, or only count them without.
+//
+static int I_ParseMus(byte* data, musevent_t* events)
+{
+	byte	velocities[MUSCHANNELS];
+	byte*	p;
+	byte*	end;
+	int	count;
+	int	time;
+	int	delay;
+	int	desc;
+	int	type;
+	int	value;
+	int	b;
+
+	if (memcmp(data, "MUS\x1a", 4))
+		return 0;
+
+	p = data + SHORT(((unsigned short*)data)[3]);
+	end = p + SHORT(((unsigned short*)data)[2]);
+
+	memset(velocities, 127, sizeof(velocities));
+	count = 0;
+	time = 0;
+
+#define NEXT	(p < end ? *p++ : 0)
+#define ADD(e, d1, d2) \
+	{ \
+		if (events) \
+		{ \
+			events[count].sample = (long long) time * SAMPLERATE / MUSRATE; \
+			events[count].event = e; \
+			events[count].channel = desc & 15; \
+			events[count].data1 = d1; \
+			events[count].data2 = d2; \
+		} \
+		count++; \
+	}
+
+	while (p < end)
+	{
+		desc = *p++;
+		type = (desc >> 4) & 7;
+
+		switch (type)
+		{
+		  case mus_releasenote:
+			b = NEXT;
+			ADD(type, b & 127, 0);
+			break;
+
+		  case mus_playnote:
+			b = NEXT;
+			if (b & 128)
+				velocities[desc & 15] = NEXT & 127;
+			ADD(type, b & 127, velocities[desc & 15]);
+			break;
+
+		  case mus_pitchwheel:
+		  case mus_system:
+			b = NEXT;
+			ADD(type, b, 0);
+			break;
+
+		  case mus_controller:
+			b = NEXT;
+			value = NEXT & 127;
+			ADD(type, b, value);
+			break;
+
+		  case mus_measureend:
+			break;
+
+		  default:
+			p = end;
+			break;
+		}
+
+		// Delay to the next event in ticks, 7 bits a byte
+		if (desc & 128)
+		{
+			delay = 0;
+			do
+			{
+				b = NEXT;
+				delay = (delay << 7) | (b & 127);
+			} while (b & 128);
+			time += delay;
+		}
+	}
+
+	desc = 0;
+	ADD(mus_scoreend, 0, 0);
+
+#undef ADD
+#undef NEXT
+
+	return count;
+}
+
+
+//
+// Voice gains from the velocity and channel settings.
+//
+static void I_VoiceGain(musvoice_t* v)
+{
+	muschannel_t*	c = &g_channels[v->channel];
+	long long	gain;
+
+	gain = (long long) VOICEPEAK * v->velocity * c->volume * c->expression * g_musVolume
+		/ (127 * 127 * 127 * 15);
+
+	// Linear pan, both sides at full in the middle
+	v->left = gain * (c->pan < 64 ? 64 : 127 - c->pan) / 64;
+	v->right = gain * (c->pan > 64 ? 64 : c->pan) / 64;
+}
+
+static void I_VoiceStep(musvoice_t* v)
+{
+	if (v->bends)
+		v->step = ((unsigned long long) g_notesteps[v->note]
+				* g_bendfactors[g_channels[v->channel].bend]) >> 16;
+	else
+		v->step = g_notesteps[v->note];
+}
+
+static int I_EnvRate(int ms, int range)
+{
+	int samples = ms * SAMPLERATE / 1000;
+	return samples > 0 ? range / samples + 1 : range;
+}
+
+
+//
+// Drum sounds by note, as noise or a fixed pitch, and how
+//  long they ring.
+//
+static void I_DrumVoice(musvoice_t* v)
+{
+	int	note = v->note;
+	int	decay;
+
+	v->wave = NULL;
+	v->bends = false;
+
+	if (note == 35 || note == 36)
+	{
+		// Kick
+		v->wave = g_waves[wave_triangle];
+		v->note = 33;
+		decay = 150;
+	}
+	else if (note == 41 || note == 43 || note == 45
+			 || note == 47 || note == 48 || note == 50)
+	{
+		// Toms
+		v->wave = g_waves[wave_triangle];
+		v->note = note + 4;
+		decay = 250;
+	}
+	else if (note >= 37 && note <= 40)
+		decay = 180;	// Snares and claps
+	else if (note == 42 || note == 44)
+		decay = 40;	// Closed hi-hat
+	else if (note == 46)
+		decay = 250;	// Open hi-hat
+	else if (note == 49 || note == 52 || note == 55 || note == 57)
+		decay = 900;	// Crash
+	else if (note == 51 || note == 53 || note == 59)
+		decay = 500;	// Ride
+	else
+		decay = 100;
+
+	v->attackrate = ENVMAX;
+	v->decayrate = I_EnvRate(decay, ENVMAX);
+	v->sustain = 0;
+	v->releaserate = v->decayrate;
+}
+
+
+//
+// A free voice below the cap, else the quietest,
+//  releasing ones first.
+//
+static musvoice_t* I_AllocVoice(void)
+{
+	musvoice_t*	free = NULL;
+	musvoice_t*	best = NULL;
+	musvoice_t*	v;
+	int		active = 0;
+	int		i;
+
+	for (i = 0; i < MAXMUSVOICES; i++)
+	{
+		v = &g_voices[i];
+		if (!v->active)
+		{
+			if (!free)
+				free = v;
+			continue;
+		}
+
+		active++;
+		if (!best
+			|| (v->stage == env_release) > (best->stage == env_release)
+			|| ((v->stage == env_release) == (best->stage == env_release)
+				&& v->env < best->env))
+			best = v;
+	}
+
+	return active < g_voiceCap ? free : best;
+}
+
+static void I_NoteOn(int channel, int note, int velocity)
+{
+	const musinstr_t*	instr;
+	musvoice_t*		v;
+
+	if (velocity == 0)
+		return;
+
+	v = I_AllocVoice();
+
+	v->active = true;
+	v->channel = channel;
+	v->note = note;
+	v->velocity = velocity;
+	v->phase = 0;
+	v->stage = env_attack;
+	v->env = 0;
+
+	if (channel == MUSPERCUSSION)
+	{
+		I_DrumVoice(v);
+	}
+	else
+	{
+		instr = &g_families[g_channels[channel].instrument >> 3];
+
+		v->wave = instr->wave == wave_noise ? NULL : g_waves[instr->wave];
+		v->bends = true;
+		v->attackrate = I_EnvRate(instr->attack, ENVMAX);
+		v->sustain = instr->sustain << 8;
+		v->decayrate = I_EnvRate(instr->decay, ENVMAX - v->sustain);
+		v->releaserate = I_EnvRate(instr->release, ENVMAX);
+	}
+
+	I_VoiceStep(v);
+	I_VoiceGain(v);
+}
+
+static void I_NoteOff(int channel, int note)
+{
+	musvoice_t*	v;
+	int		i;
+
+	for (i = 0; i < MAXMUSVOICES; i++)
+	{
+		v = &g_voices[i];
+		if (v->active && v->channel == channel
+			&& (note < 0 || v->note == note) && v->stage != env_release)
+			v->stage = env_release;
+	}
+}
+
+static void I_ResetChannels(void)
+{
+	int i;
+
+	for (i = 0; i < MUSCHANNELS; i++)
+	{
+		g_channels[i].instrument = 0;
+		g_channels[i].volume = 100;
+		g_channels[i].pan = 64;
+		g_channels[i].expression = 127;
+		g_channels[i].bend = 128;
+	}
+}
+
+//
+// Apply a changed channel to its voices.
+//
+static void I_UpdateChannel(int channel)
+{
+	musvoice_t*	v;
+	int		i;
+
+	for (i = 0; i < MAXMUSVOICES; i++)
+	{
+		v = &g_voices[i];
+		if (v->active && v->channel == channel)
+		{
+			I_VoiceStep(v);
+			I_VoiceGain(v);
+		}
+	}
+}
+
+
+static void I_PlayEvent(musevent_t* ev)
+{
+	muschannel_t*	c = &g_channels[ev->channel];
+
+	switch (ev->event)
+	{
+	  case mus_releasenote:
+		I_NoteOff(ev->channel, ev->data1);
+		break;
+
+	  case mus_playnote:
+		I_NoteOn(ev->channel, ev->data1, ev->data2);
+		break;
+
+	  case mus_pitchwheel:
+		c->bend = ev->data1;
+		I_UpdateChannel(ev->channel);
+		break;
+
+	  case mus_system:
+		if (ev->data1 == mussys_soundsoff || ev->data1 == mussys_notesoff)
+			I_NoteOff(ev->channel, -1);
+		else if (ev->data1 == mussys_resetctrls)
+		{
+			c->volume = 100;
+			c->pan = 64;
+			c->expression = 127;
+			c->bend = 128;
+			I_UpdateChannel(ev->channel);
+		}
+		break;
+
+	  case mus_controller:
+		if (ev->data1 == musctrl_instrument)
+			c->instrument = ev->data2;
+		else if (ev->data1 == musctrl_volume)
+			c->volume = ev->data2;
+		else if (ev->data1 == musctrl_pan)
+			c->pan = ev->data2;
+		else if (ev->data1 == musctrl_expression)
+			c->expression = ev->data2;
+		I_UpdateChannel(ev->channel);
+		break;
+	}
+}
+
+
+//
+// Advance the envelope of a voice by count samples.
+//
+static void I_VoiceEnvelope(musvoice_t* v, int count)
+{
+	switch (v->stage)
+	{
+	  case env_attack:
+		v->env += v->attackrate * count;
+		if (v->env >= ENVMAX)
+		{
+			v->env = ENVMAX;
+			v->stage = v->sustain < ENVMAX ? env_decay : env_sustain;
+		}
+		break;
+
+	  case env_decay:
+		v->env -= v->decayrate * count;
+		if (v->env <= v->sustain)
+		{
+			v->env = v->sustain;
+			v->stage = env_sustain;
+		}
+		break;
+
+	  case env_sustain:
+		break;
+
+	  case env_release:
+		v->env -= v->releaserate * count;
+		break;
+	}
+
+	// Decayed or released
+	if (v->env <= 0 && v->stage != env_attack)
+	{
+		v->env = 0;
+		v->active = false;
+	}
+}
+
+
+//
+// Render count samples of every voice, the gains ramp
+//  along the envelope.
+//
+static void I_RenderVoices(int* mix, int count, boolean stereo)
+{
+	musvoice_t*	v;
+	short*		wave;
+	unsigned	phase;
+	unsigned	step;
+	int		env;
+	int		gl;
+	int		gr;
+	int		dl;
+	int		dr;
+	int		s;
+	int		i;
+	int		j;
+
+	for (j = 0; j < MAXMUSVOICES; j++)
+	{
+		v = &g_voices[j];
+		if (!v->active)
+			continue;
+
+		g_musVoiceSamples += count;
+
+		env = v->env;
+		I_VoiceEnvelope(v, count);
+
+		// Gains in 16.16
+		gl = v->left * env;
+		gr = v->right * env;
+		dl = v->left * (v->env - env) / count;
+		dr = v->right * (v->env - env) / count;
+
+		wave = v->wave;
+		phase = v->phase;
+		step = v->step;
+
+		if (!wave)
+		{
+			// Noise, the phase is the generator state
+			for (i = 0; i < count; i++)
+			{
+				phase = phase * 1664525 + 1013904223;
+				s = (short)(phase >> 16) >> 1;
+				if (stereo)
+				{
+					mix[2*i] += (s * (gl >> 16)) >> 15;
+					mix[2*i+1] += (s * (gr >> 16)) >> 15;
+				}
+				else
+				{
+					mix[i] += (s * (gl >> 16)) >> 15;
+				}
+				gl += dl;
+				gr += dr;
+			}
+		}
+		else if (stereo)
+		{
+			for (i = 0; i < count; i++)
+			{
+				s = wave[phase >> 24];
+				phase += step;
+				mix[2*i] += (s * (gl >> 16)) >> 15;
+				mix[2*i+1] += (s * (gr >> 16)) >> 15;
+				gl += dl;
+				gr += dr;
+			}
+		}
+		else
+		{
+			for (i = 0; i < count; i++)
+			{
+				s = wave[phase >> 24];
+				phase += step;
+				mix[i] += (s * (gl >> 16)) >> 15;
+				gl += dl;
+			}
+		}
+
+		v->phase = phase;
+	}
+}
+
+
+//
+// Drop the quietest voices down to the cap.
+//
+static void I_CapVoices(void)
+{
+	musvoice_t*	quietest;
+	int		active;
+	int		i;
+
+	for (;;)
+	{
+		active = 0;
+		quietest = NULL;
+		for (i = 0; i < MAXMUSVOICES; i++)
+		{
+			if (!g_voices[i].active)
+				continue;
+			active++;
+			if (!quietest || g_voices[i].env < quietest->env)
+				quietest = &g_voices[i];
+		}
+
+		if (active <= g_voiceCap)
+			break;
+		quietest->active = false;
+	}
+}
+
+
+static boolean I_VoicesActive(void)
+{
+	int i;
+
+	for (i = 0; i < MAXMUSVOICES; i++)
+	{
+		if (g_voices[i].active)
+			return true;
+	}
+
+	return false;
+}
+
+
+int I_MusicVoices(void)
+{
+	int count = 0;
+	int i;
+
+	for (i = 0; i < MAXMUSVOICES; i++)
+		count += g_voices[i].active;
+
+	return count;
+}
+
+
+//
+// Read without the lock by the mixer deciding to sleep,
+//  I_PlaySong and I_ResumeSong wake it.
+//
+boolean I_MusicActive(void)
+{
+	return !g_paused && (g_playing || I_VoicesActive());
+}
+
+
+//
+// Play the events due now, ending or looping the song.
+//
+static void I_PlayEvents(void)
+{
+	musevent_t*	ev;
+	int		i;
+
+	while (g_playing && g_event < g_numEvents
+		   && g_events[g_event].sample <= g_position)
+	{
+		ev = &g_events[g_event++];
+
+		if (ev->event != mus_scoreend)
+		{
+			I_PlayEvent(ev);
+		}
+		else if (g_looping && ev->sample > 0)
+		{
+			// A song without length cannot loop
+			g_position -= ev->sample;
+			g_event = 0;
+		}
+		else
+		{
+			g_playing = false;
+			for (i = 0; i < MUSCHANNELS; i++)
+				I_NoteOff(i, -1);
+		}
+	}
+}
+
+
+void I_MixMusic(int* mix, int count, boolean stereo, boolean budget)
+{
+	struct timespec	start;
+	struct timespec	end;
+	long long	nanos;
+	long long	allowed;
+	int		total;
+	int		n;
+
+	pthread_mutex_lock(&g_musLock);
+
+	// Nothing to time when silent
+	if (g_paused || (!g_playing && !I_VoicesActive()))
+	{
+		pthread_mutex_unlock(&g_musLock);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	total = count;
+
+	while (count && (g_playing || I_VoicesActive()))
+	{
+		I_PlayEvents();
+
+		// Up to the next event
+		n = count;
+		if (n > MUSBATCH)
+			n = MUSBATCH;
+		if (g_playing && g_event < g_numEvents
+			&& g_events[g_event].sample - g_position < n)
+			n = g_events[g_event].sample - g_position;
+
+		I_RenderVoices(mix, n, stereo);
+
+		mix += n * (stereo ? 2 : 1);
+		count -= n;
+		g_position += n;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	nanos = (end.tv_sec - start.tv_sec) * 1000000000LL + end.tv_nsec - start.tv_nsec;
+	g_musNanos += nanos;
+	g_musSamples += total;
+
+	// Shed voices over the budget, take them back well under it
+	if (budget && g_budget > 0)
+	{
+		allowed = (long long) total * 10000000 * g_budget / SAMPLERATE;
+		if (nanos > allowed && g_voiceCap > 1)
+		{
+			g_voiceCap--;
+			I_CapVoices();
+		}
+		else if (nanos * 2 < allowed && g_voiceCap < g_maxVoices)
+		{
+			g_voiceCap++;
+		}
+	}
+
+	pthread_mutex_unlock(&g_musLock);
+}
+
+
+void I_SetMusicVolume(int volume)
+{
+	int i;
+
+	// Internal state variable.
+	snd_MusicVolume = volume;
+
+	pthread_mutex_lock(&g_musLock);
+
+	g_musVolume = volume > 15 ? 15 : volume;
+	for (i = 0; i < MAXMUSVOICES; i++)
+	{
+		if (g_voices[i].active)
+			I_VoiceGain(&g_voices[i]);
+	}
+
+	pthread_mutex_unlock(&g_musLock);
+}
+
+
+//
+// Only one song is registered at a time, its handle is 1.
+//
+int I_RegisterSong(void* data)
+{
+	int count;
+
+	I_UnRegisterSong(1);
+
+	count = I_ParseMus(data, NULL);
+	if (!count)
+	{
+		fprintf(stderr, "I_RegisterSong: not a MUS lump\n");
+		return 0;
+	}
+
+	pthread_mutex_lock(&g_musLock);
+
+	g_events = Z_Malloc(count * sizeof(musevent_t), PU_STATIC, NULL);
+	g_numEvents = I_ParseMus(data, g_events);
+
+	pthread_mutex_unlock(&g_musLock);
+
+	return 1;
+}
+
+void I_UnRegisterSong(int handle)
+{
+	pthread_mutex_lock(&g_musLock);
+
+	g_playing = false;
+	memset(g_voices, 0, sizeof(g_voices));
+	if (g_events)
+		Z_Free(g_events);
+	g_events = NULL;
+	g_numEvents = 0;
+
+	pthread_mutex_unlock(&g_musLock);
+}
+
+void I_PlaySong(int handle, int looping)
+{
+	pthread_mutex_lock(&g_musLock);
+
+	memset(g_voices, 0, sizeof(g_voices));
+	I_ResetChannels();
+	g_event = 0;
+	g_position = 0;
+	g_looping = looping;
+	g_paused = false;
+	g_playing = g_numEvents > 0;
+
+	pthread_mutex_unlock(&g_musLock);
+
+	I_WakeMixer();
+}
+
+void I_PauseSong(int handle)
+{
+	pthread_mutex_lock(&g_musLock);
+	g_paused = true;
+	pthread_mutex_unlock(&g_musLock);
+}
+
+void I_ResumeSong(int handle)
+{
+	pthread_mutex_lock(&g_musLock);
+	g_paused = false;
+	pthread_mutex_unlock(&g_musLock);
+
+	I_WakeMixer();
+}
+
+//
+// Stopped notes fade out over their release.
+//
+void I_StopSong(int handle)
+{
+	int i;
+
+	pthread_mutex_lock(&g_musLock);
+
+	g_playing = false;
+	for (i = 0; i < MUSCHANNELS; i++)
+		I_NoteOff(i, -1);
+
+	pthread_mutex_unlock(&g_musLock);
+}
+
+// Is the song playing?
+int I_QrySongPlaying(int handle)
+{
+	return g_playing;
+}
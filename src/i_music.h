@@ -0,0 +1,51 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	MUS software synth, mixed by i_sound.c. The music API
+//	itself is declared in i_sound.h.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __I_MUSIC__
+#define __I_MUSIC__
+
+
+#include "doomtype.h"
+
+
+//
+// Adds count samples of the playing song to the mix, left and
+//  right interleaved when stereo. With budget set, the synth
+//  drops voices while it takes more than -musbudget of the
+//  real time. Called by the mixer.
+//
+void I_MixMusic(int* mix, int count, boolean stereo, boolean budget);
+
+// Notes sounding now, for the telemetry.
+int I_MusicVoices(void);
+
+// Anything to mix, a song or notes fading out.
+boolean I_MusicActive(void);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
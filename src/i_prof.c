@@ -0,0 +1,183 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Frame phase timing. Each phase accumulates over a frame, frames
+//	go into a ring of the most recent PROFFRAMES, summarized at exit.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "i_prof.h"
+#include "i_system.h"
+#include "m_argv.h"
+
+
+#define PROFFRAMES 2048
+
+boolean g_profiling = false;
+
+static char* g_phaseNames[NUMPROFPHASES] =
+{
+	"frame", "tics", "render", "bsp", "planes", "masked", "viewwait",
+	"statusbar", "menu", "finishupdate", "push"
+};
+
+// -profile <name>: CSV with one line per frame in the ring
+static char* g_csvName = NULL;
+
+// Start of the running phases and time accumulated this frame, ns.
+// The push phase is written from the display thread.
+static long long g_start[NUMPROFPHASES];
+static long long g_current[NUMPROFPHASES];
+static long long g_lastFrame;
+
+// Microseconds per phase of the recent frames
+static unsigned g_ring[PROFFRAMES][NUMPROFPHASES];
+static int g_frames = 0;
+
+static long long I_ProfileNow(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+void I_InitProfile(void)
+{
+	int p = M_CheckParm("-profile");
+	if (!p)
+		return;
+
+	if (p < myargc - 1 && myargv[p + 1][0] != '-')
+		g_csvName = myargv[p + 1];
+
+	memset(g_current, 0, sizeof(g_current));
+	g_lastFrame = I_ProfileNow();
+	g_profiling = true;
+}
+
+void I_ProfileStart(profphase_t phase)
+{
+	g_start[phase] = I_ProfileNow();
+}
+
+void I_ProfileStop(profphase_t phase)
+{
+	__atomic_fetch_add(&g_current[phase], I_ProfileNow() - g_start[phase], __ATOMIC_RELAXED);
+}
+
+void I_ProfileEndFrame(void)
+{
+	unsigned* sample;
+	long long now;
+	int i;
+
+	if (!g_profiling)
+		return;
+
+	now = I_ProfileNow();
+	g_current[prof_frame] = now - g_lastFrame;
+	g_lastFrame = now;
+
+	sample = g_ring[g_frames % PROFFRAMES];
+	for (i = 0; i < NUMPROFPHASES; i++)
+	{
+		sample[i] = __atomic_exchange_n(&g_current[i], 0, __ATOMIC_RELAXED) / 1000;
+	}
+	g_frames++;
+}
+
+static int I_CompareSamples(const void* a, const void* b)
+{
+	unsigned x = *(const unsigned*)a;
+	unsigned y = *(const unsigned*)b;
+	return x < y ? -1 : x > y;
+}
+
+void I_ShutdownProfile(void)
+{
+	static unsigned sorted[PROFFRAMES];
+	int count;
+	int first;
+	int i, j;
+
+	if (!g_profiling || !g_frames)
+		return;
+
+	g_profiling = false;
+
+	// The first frame of the ring includes the startup, skip it
+	// while the ring has not wrapped
+	count = g_frames < PROFFRAMES ? g_frames - 1 : PROFFRAMES;
+	first = g_frames - count;
+	if (!count)
+		return;
+
+	fprintf(stderr, "profile: last %d frames, microseconds\n", count);
+	fprintf(stderr, "%-13s %8s %8s %8s %8s\n", "phase", "min", "avg", "max", "p99");
+	for (i = 0; i < NUMPROFPHASES; i++)
+	{
+		long long sum = 0;
+		for (j = 0; j < count; j++)
+		{
+			sorted[j] = g_ring[(first + j) % PROFFRAMES][i];
+			sum += sorted[j];
+		}
+		qsort(sorted, count, sizeof(sorted[0]), I_CompareSamples);
+
+		fprintf(stderr, "%-13s %8u %8lld %8u %8u\n", g_phaseNames[i],
+				sorted[0], sum / count, sorted[count - 1], sorted[count * 99 / 100]);
+	}
+
+	if (g_csvName)
+	{
+		FILE* f = fopen(g_csvName, "w");
+		if (!f)
+		{
+			fprintf(stderr, "profile: cannot write %s\n", g_csvName);
+			return;
+		}
+
+		fprintf(f, "index");
+		for (i = 0; i < NUMPROFPHASES; i++)
+		{
+			fprintf(f, ",%s", g_phaseNames[i]);
+		}
+		fprintf(f, "\n");
+
+		for (j = 0; j < count; j++)
+		{
+			unsigned* sample = g_ring[(first + j) % PROFFRAMES];
+			fprintf(f, "%d", first + j);
+			for (i = 0; i < NUMPROFPHASES; i++)
+			{
+				fprintf(f, ",%u", sample[i]);
+			}
+			fprintf(f, "\n");
+		}
+		fclose(f);
+
+		fprintf(stderr, "profile: wrote %s\n", g_csvName);
+	}
+}
@@ -0,0 +1,77 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Frame phase timing, enabled with -profile [file.csv].
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __I_PROF__
+#define __I_PROF__
+
+
+#include "doomtype.h"
+
+
+//
+// Timed phases of a frame. Phases may nest, the display
+//  push may run on the display thread and the view on the
+//  render thread.
+//
+typedef enum
+{
+    prof_frame,		// D_DoomLoop pass, start to start
+    prof_tics,		// TryRunTics
+    prof_render,	// R_RenderPlayerView
+    prof_bsp,		//  R_RenderBSPNode
+    prof_planes,	//  R_DrawPlanes
+    prof_masked,	//  R_DrawMasked
+    prof_viewwait,	// D_Display waiting on the render thread
+    prof_statusbar,	// ST_Drawer
+    prof_menu,		// M_Drawer
+    prof_finish,	// I_FinishUpdate on the game thread
+    prof_push,		// Sending a frame to the video device
+    NUMPROFPHASES
+
+} profphase_t;
+
+
+extern boolean	g_profiling;
+
+void I_InitProfile (void);
+
+// Prints min/avg/max/p99 of each phase, writes the CSV.
+void I_ShutdownProfile (void);
+
+void I_ProfileStart (profphase_t phase);
+void I_ProfileStop (profphase_t phase);
+
+// Called by D_DoomLoop once per pass.
+void I_ProfileEndFrame (void);
+
+
+// Cheap enough to leave in when profiling is off.
+#define PROF_START(p)	do { if (g_profiling) I_ProfileStart (p); } while (0)
+#define PROF_STOP(p)	do { if (g_profiling) I_ProfileStop (p); } while (0)
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Audio output devices behind i_sound.c.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __I_SNDDEV__
+#define __I_SNDDEV__
+
+
+#include "doomtype.h"
+
+
+#define SAMPLERATE		11025	// Hz
+
+
+//
+// What drives the mixer for a device.
+//
+typedef enum
+{
+    // Write gets one sample at a time at SAMPLERATE,
+    //  from a real time output thread fed by the mixer thread.
+    snd_realtime,
+
+    // Write gets blocks as fast as the mixer thread makes them.
+    snd_freerun,
+
+    // Write gets SAMPLERATE/TICRATE samples per game tic,
+    //  mixed on the game thread.
+    snd_gametic
+
+} sndclock_t;
+
+
+//
+// An audio output device, 16 bit signed samples,
+//  left and right interleaved for stereo devices.
+//
+typedef struct
+{
+    // Selected with -audio <name>.
+    char*	name;
+
+    sndclock_t	clock;
+    boolean	stereo;
+
+    // Bits the device resolves, the output is
+    //  noise shaped below 16.
+    int		bits;
+
+    // Returns false when the device cannot be used.
+    boolean	(*Init) (void);
+    void	(*Shutdown) (void);
+
+    // count is in samples per channel.
+    void	(*Write) (short* samples, int count);
+
+} snddev_t;
+
+
+// Output conditioning between the mixer and the device, i_sndshape.c.
+// Sets up for a device resolving bits, oversampling by 1, 2 or 4.
+void I_InitShaping(int bits, int oversample, boolean stereo);
+
+// Turns count mixed samples into count * oversample samples
+//  for the device. Returns how many.
+int I_ShapeOutput(int* mix, short* out, int count);
+
+// Something may play now, the realtime mixer and output
+//  threads stop sleeping. Called by the music when it starts.
+void I_WakeMixer(void);
+
+
+// PWM on Arduino pin 3 through sysfs, i_sndpwm.c.
+extern snddev_t		pwmsnddev;
+
+// Discards the samples, for timing the mixer, i_sndnull.c.
+extern snddev_t		nullsnddev;
+
+// Records to a WAV file in step with the game, i_sndwav.c.
+extern snddev_t		wavsnddev;
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
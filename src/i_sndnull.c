@@ -0,0 +1,68 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Audio device that discards everything, so the mixer runs as fast
+//	as it can. i_sound.c reports the mixing cost at shutdown.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <time.h>
+
+#include "doomdef.h"
+#include "i_snddev.h"
+
+
+static long long g_samples;
+static struct timespec g_start;
+
+static boolean NULL_Init(void)
+{
+	g_samples = 0;
+	clock_gettime(CLOCK_MONOTONIC, &g_start);
+	return true;
+}
+
+static void NULL_Shutdown(void)
+{
+	struct timespec t;
+	double seconds;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	seconds = (t.tv_sec - g_start.tv_sec) + (t.tv_nsec - g_start.tv_nsec) / 1.0e9;
+
+	fprintf(stderr, "null audio: %lld samples in %.2f s, %.1f times real time\n",
+			g_samples, seconds, g_samples / (seconds * SAMPLERATE));
+}
+
+static void NULL_Write(short* samples, int count)
+{
+	g_samples += count;
+}
+
+snddev_t nullsnddev =
+{
+	"null",
+	snd_freerun,
+	true,
+	16,
+	NULL_Init,
+	NULL_Shutdown,
+	NULL_Write
+};
@@ -0,0 +1,139 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Audio output as PWM on an Arduino pin, through the sysfs
+//	duty_cycle file, followed by an RC low pass filter.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef NOMRAA
+
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <mraa/pwm.h>
+
+#include "doomdef.h"
+#include "i_snddev.h"
+
+
+// Config for audio PWM pin
+static const int PWM_CHIP_ID = 0;
+static const int PWM_PIN = 0;
+static const int PWM_ARDUINO_PIN = 3; // Arduino pin 3 is PWM0 on chip 0
+static const int PWM_PERIOD_USEC = 10; // Pick a period that works well with your capacitor/resistor low pass filter
+
+// Samples are quantized to PWMLEVELS duty levels, about what the
+// PWM block resolves, whose text is formatted once. A sample only
+// costs a write() when the level changes. The device is 8 bits
+// so the samples come noise shaped to the levels.
+#define PWMLEVELS 256
+
+typedef struct
+{
+	char text[12];
+	int length;
+} pwmduty_t;
+
+static pwmduty_t g_pwmDuty[PWMLEVELS];
+static mraa_pwm_context g_pwm = NULL;
+static int g_pwmFile = -1;
+static int g_pwmLevel = -1;
+
+static boolean PWM_Init(void)
+{
+	char name[64];
+	int i;
+
+	g_pwm = mraa_pwm_init(PWM_ARDUINO_PIN);
+	if (g_pwm == NULL)
+	{
+		fprintf(stderr, "Cannot open PWM pin %d\n", PWM_ARDUINO_PIN);
+		return false;
+	}
+
+	mraa_pwm_period_us(g_pwm, PWM_PERIOD_USEC);
+	//mraa_pwm_write_period(g_pwm, PWM_PERIOD_USEC * 1000);
+	mraa_pwm_enable(g_pwm, 1);
+
+	snprintf(name, sizeof(name), "/sys/class/pwm/pwmchip%d/pwm%d/duty_cycle", PWM_CHIP_ID, PWM_PIN);
+	g_pwmFile = open(name, O_RDWR);
+	if (g_pwmFile == -1)
+	{
+		fprintf(stderr, "Cannot open PWM duty file %s\n", name);
+		return false;
+	}
+
+	// Duty cycle in ns for each level
+	for (i = 0; i < PWMLEVELS; i++)
+	{
+		g_pwmDuty[i].length = snprintf(g_pwmDuty[i].text, sizeof(g_pwmDuty[i].text),
+				"%d", i * (PWM_PERIOD_USEC * 1000) / PWMLEVELS);
+	}
+
+	return true;
+}
+
+static void PWM_Shutdown(void)
+{
+	if (g_pwmFile != -1)
+	{
+		close(g_pwmFile);
+		g_pwmFile = -1;
+	}
+
+	if (g_pwm)
+	{
+		mraa_pwm_enable(g_pwm, 0);
+		mraa_pwm_close(g_pwm);
+		g_pwm = NULL;
+	}
+}
+
+static void PWM_Write(short* samples, int count)
+{
+	int level;
+
+	for (; count; count--)
+	{
+		level = (*samples++ + 0x8000) * PWMLEVELS >> 16;
+		if (level == g_pwmLevel)
+			continue;
+
+		g_pwmLevel = level;
+		if (write(g_pwmFile, g_pwmDuty[level].text, g_pwmDuty[level].length) == -1)
+		{
+			fprintf(stderr, "PWM duty write failure\n");
+		}
+	}
+}
+
+snddev_t pwmsnddev =
+{
+	"pwm",
+	snd_realtime,
+	false,
+	8,
+	PWM_Init,
+	PWM_Shutdown,
+	PWM_Write
+};
+
+#endif // NOMRAA
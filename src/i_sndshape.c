@@ -0,0 +1,226 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Output conditioning between the mixer and the audio device.
+//	The mix gets its gain and a soft limiter from a table, is
+//	optionally oversampled, and is quantized to what the device
+//	resolves with error feedback, which moves the quantization
+//	noise of a few bit PWM up towards the top of the band, where
+//	the RC filter takes it out.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "doomdef.h"
+#include "m_argv.h"
+#include "i_snddev.h"
+
+
+// PWM has very limited bit resolution, make sounds louder
+//  to use more of the available range.
+#define OUTPUTGAIN		8
+
+// Limiter table, above the knee, interpolated between entries
+#define LIMITSHIFT		6
+#define LIMITSIZE		1024
+
+
+static int		g_limit[LIMITSIZE+1];
+static int		g_knee;
+static int		g_ceiling;
+
+static int		g_oversample = 1;
+static int		g_step;		// Quantizer step, 1 for 16 bits
+static int		g_order;	// Of the error feedback
+static int		g_channels;
+
+// Per channel: the last input, for oversampling, and the last
+//  two quantization errors
+static int		g_last[2];
+static int		g_error1[2];
+static int		g_error2[2];
+
+
+void I_InitShaping(int bits, int oversample, boolean stereo)
+{
+	double	range;
+	int	p;
+	int	i;
+
+	g_oversample = oversample;
+	g_channels = stereo ? 2 : 1;
+	g_step = bits < 16 ? 1 << (16 - bits) : 1;
+
+	// First order by default, the noise of second order
+	//  only goes above the band when oversampling
+	g_order = g_step == 1 ? 0 : oversample > 1 ? 2 : 1;
+	p = M_CheckParm("-noiseshape");
+	if (p && p < myargc-1)
+		g_order = atoi(myargv[p+1]);
+	if (g_order < 0)
+		g_order = 0;
+	if (g_order > 2)
+		g_order = 2;
+	if (g_step == 1)
+		g_order = 0;
+
+	// A step of headroom keeps the error feedback stable,
+	//  linear up to half of that
+	g_ceiling = 32767 - 2 * g_step;
+	g_knee = g_ceiling / 2;
+
+	// Saturates smoothly towards the ceiling
+	range = g_ceiling - g_knee;
+	for (i = 0; i <= LIMITSIZE; i++)
+		g_limit[i] = g_knee + range * tanh((i << LIMITSHIFT) / range);
+
+	for (i = 0; i < 2; i++)
+		g_last[i] = g_error1[i] = g_error2[i] = 0;
+
+	if (g_step > 1)
+		fprintf(stderr, "I_InitShaping: %d bit output, %dx oversampling, order %d noise shaping\n",
+				bits, oversample, g_order);
+}
+
+
+//
+// Gain and soft limit of a mixed sample.
+//
+static int I_Limit(int x)
+{
+	int	a;
+	int	i;
+	int	f;
+
+	x *= OUTPUTGAIN;
+	a = x < 0 ? -x : x;
+	if (a <= g_knee)
+		return x;
+
+	a -= g_knee;
+	i = a >> LIMITSHIFT;
+	if (i >= LIMITSIZE)
+		a = g_ceiling;
+	else
+	{
+		f = a & ((1 << LIMITSHIFT) - 1);
+		a = g_limit[i] + (((g_limit[i+1] - g_limit[i]) * f) >> LIMITSHIFT);
+	}
+
+	return x < 0 ? -a : a;
+}
+
+
+//
+// Quantize to the device step, feeding back the errors so their
+//  spectrum is shaped by (1 - z^-1)^order.
+//
+static int I_Quantize(int u, int c)
+{
+	int	y;
+	int	e;
+
+	if (g_order == 1)
+		u -= g_error1[c];
+	else if (g_order == 2)
+		u -= 2 * g_error1[c] - g_error2[c];
+
+	y = (u + g_step / 2) & ~(g_step - 1);
+	if (y > 32767 - g_step + 1)
+		y = 32767 - g_step + 1;
+	else if (y < -32768)
+		y = -32768;
+
+	// Errors from clipping would not go away, keep them bounded
+	e = y - u;
+	if (e > g_step)
+		e = g_step;
+	else if (e < -g_step)
+		e = -g_step;
+
+	g_error2[c] = g_error1[c];
+	g_error1[c] = e;
+
+	return y;
+}
+
+
+//
+// Turns count mixed samples into count * oversample samples
+//  for the device, interleaved like the mix. Returns how many.
+//
+int I_ShapeOutput(int* mix, short* out, int count)
+{
+	int	i;
+	int	c;
+	int	k;
+	int	x;
+	int	last;
+	int	lo;
+	int	hi;
+	int	n;
+
+	if (g_step == 1 && g_oversample == 1)
+	{
+		n = count * g_channels;
+
+		// Mostly the whole block is below the knee, which
+		//  vectorizes
+		lo = hi = 0;
+		for (i = 0; i < n; i++)
+		{
+			lo = mix[i] < lo ? mix[i] : lo;
+			hi = mix[i] > hi ? mix[i] : hi;
+		}
+
+		if (hi * OUTPUTGAIN <= g_knee && -lo * OUTPUTGAIN <= g_knee)
+		{
+			for (i = 0; i < n; i++)
+				out[i] = mix[i] * OUTPUTGAIN;
+		}
+		else
+		{
+			for (i = 0; i < n; i++)
+				out[i] = I_Limit(mix[i]);
+		}
+		return count;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		for (c = 0; c < g_channels; c++)
+		{
+			x = I_Limit(mix[i * g_channels + c]);
+			last = g_last[c];
+			g_last[c] = x;
+
+			// Linear steps from the last sample
+			for (k = 1; k <= g_oversample; k++)
+			{
+				out[(i * g_oversample + k - 1) * g_channels + c] =
+					I_Quantize(last + (x - last) * k / g_oversample, c);
+			}
+		}
+	}
+
+	return count * g_oversample;
+}
@@ -0,0 +1,123 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Audio device recording the mix to a WAV file. Mixing follows the
+//	game tics instead of the clock, so a demo always gives the same
+//	file, however fast it runs.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "doomdef.h"
+#include "i_snddev.h"
+#include "m_argv.h"
+
+
+// -wavfile <name>, default below
+static char* g_fileName = "sound.wav";
+static FILE* g_file = NULL;
+static uint32_t g_samples;
+
+static void WAV_Write32(uint32_t v)
+{
+	fputc(v, g_file);
+	fputc(v >> 8, g_file);
+	fputc(v >> 16, g_file);
+	fputc(v >> 24, g_file);
+}
+
+static void WAV_Write16(uint16_t v)
+{
+	fputc(v, g_file);
+	fputc(v >> 8, g_file);
+}
+
+// RIFF header of a 16 bit stereo PCM file with the given number of samples
+static void WAV_WriteHeader(uint32_t samples)
+{
+	fwrite("RIFF", 1, 4, g_file);
+	WAV_Write32(36 + samples * 4);
+	fwrite("WAVEfmt ", 1, 8, g_file);
+	WAV_Write32(16);
+	WAV_Write16(1); // PCM
+	WAV_Write16(2); // Channels
+	WAV_Write32(SAMPLERATE);
+	WAV_Write32(SAMPLERATE * 4); // Bytes per second
+	WAV_Write16(4); // Bytes per sample frame
+	WAV_Write16(16); // Bits per sample
+	fwrite("data", 1, 4, g_file);
+	WAV_Write32(samples * 4);
+}
+
+static boolean WAV_Init(void)
+{
+	int p = M_CheckParm("-wavfile");
+	if (p && p < myargc - 1)
+		g_fileName = myargv[p + 1];
+
+	g_file = fopen(g_fileName, "wb");
+	if (!g_file)
+	{
+		fprintf(stderr, "Cannot write %s\n", g_fileName);
+		return false;
+	}
+
+	// Sizes are filled in at shutdown
+	g_samples = 0;
+	WAV_WriteHeader(0);
+	return true;
+}
+
+static void WAV_Shutdown(void)
+{
+	if (!g_file)
+		return;
+
+	fseek(g_file, 0, SEEK_SET);
+	WAV_WriteHeader(g_samples);
+	fclose(g_file);
+	g_file = NULL;
+
+	fprintf(stderr, "wav audio: %u samples, %.2f s written to %s\n",
+			g_samples, (double)g_samples / SAMPLERATE, g_fileName);
+}
+
+static void WAV_Write(short* samples, int count)
+{
+	int i;
+
+	for (i = 0; i < count * 2; i++)
+	{
+		WAV_Write16(samples[i]);
+	}
+	g_samples += count;
+}
+
+snddev_t wavsnddev =
+{
+	"wav",
+	snd_gametic,
+	true,
+	16,
+	WAV_Init,
+	WAV_Shutdown,
+	WAV_Write
+};
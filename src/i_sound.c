@@ -24,45 +24,70 @@
 static const char
 rcsid[] = "$Id: i_unix.c,v 1.5 1997/02/03 22:45:10 b1 Exp $";
 
+// For the CPU affinity of the audio threads
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdarg.h>
 #include <math.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <pthread.h>
-
-#include <mraa/pwm.h>
+#include <sched.h>
+#include <time.h>
 
 #include "z_zone.h"
 
 #include "i_system.h"
+#include "i_snddev.h"
 #include "i_sound.h"
+#include "i_music.h"
 #include "m_argv.h"
 #include "m_misc.h"
+#include "m_swap.h"
 #include "w_wad.h"
 
 #include "doomdef.h"
 
 
-// Config for audio PWM pin
-static const int PWM_CHIP_ID = 0;
-static const int PWM_PIN = 0;
-static const int PWM_ARDUINO_PIN = 3; // Arduino pin 3 is PWM0 on chip 0
-static const int PWM_PERIOD_USEC = 10; // Pick a period that works well with your capacitor/resistor low pass filter
-
-
 // The number of internal mixing channels,
 //  the samples calculated for each mixing step,
 //  the size of the 16bit, 2 hardware channel (stereo)
 //  mixing buffer, and the samplerate of the raw data.
 
-#define NUM_CHANNELS		8
+// As many as S_Init may ask for, only numChannels are used.
+#define NUM_CHANNELS		MAXVOICES
 
-#define SAMPLERATE		11025	// Hz
 #define SAMPLESIZE		2   	// 16bit
 
-// The actual lengths of all sound effects.
-int 		lengths[NUMSFX];
+// Volume levels that get their own attenuated copy of a sound
+#define VOLBUCKETS		32
+
+// Bytes all the volume copies together may take
+#define SFXCOPYBYTES		(4*1024*1024)
+
+//
+// A sound effect converted once to the output rate as signed
+//  16 bit samples. Copies attenuated to each volume bucket are
+//  made when a sound starts at that volume, on the game thread,
+//  so mixing a channel is a plain add. The top bucket is the
+//  sound itself.
+//
+typedef struct
+{
+	short*	samples;		// Full volume
+	int	length;			// In output samples
+	short*	volumes[VOLBUCKETS];
+
+} sfxcache_t;
+
+static sfxcache_t	g_sfxcache[NUMSFX];
+
+// Bytes held by the cache, and by the volume copies
+static int		g_sfxcacheBytes;
+static int		g_sfxcopyBytes;
 
 
 // The channel step amount...
@@ -71,9 +96,9 @@ unsigned int	channelstep[NUM_CHANNELS];
 unsigned int	channelstepremainder[NUM_CHANNELS];
 
 
-// The channel data pointers, start and end.
-unsigned char*	channels[NUM_CHANNELS];
-unsigned char*	channelsend[NUM_CHANNELS];
+// The sound of a channel and the next sample to play.
+sfxcache_t*	channels[NUM_CHANNELS];
+int		channelpos[NUM_CHANNELS];
 
 
 // Time/gametic that the channel started playing,
@@ -96,12 +121,227 @@ int		channelids[NUM_CHANNELS];
 // Pitch to stepping lookup, unused.
 int		steptable[256];
 
-// Volume lookups.
-int		vol_lookup[128*256];
+// Hardware left and right channel sound, attenuated.
+short*		channelleft[NUM_CHANNELS];
+short*		channelright[NUM_CHANNELS];
+
+// Bit per playing channel, so the mixer only visits those.
+//  Only the game thread writes it.
+static unsigned	g_activeMask;
+
+// Bumped by the game thread when a channel stops or starts,
+//  odd while it writes the sound and step of the channel.
+static unsigned	g_channelgen[NUM_CHANNELS];
+
+// The generation the mixer played to the end. The game thread
+//  takes the channel back from there.
+static unsigned	g_channeldone[NUM_CHANNELS];
+
+// The generation channelpos and channelstepremainder are of,
+//  only the mixer touches the three.
+static unsigned	g_mixgen[NUM_CHANNELS];
+
+// Channels playing when the game paused, held until it
+//  resumes. Sounds started meanwhile, menus, still play.
+static unsigned	g_heldMask;
+
+
+// The audio device takes left and right samples.
+static boolean	g_stereo;
+
+static void I_MixToTic(void);
+
+
+// Started and not played to the end
+static unsigned I_ActiveChannels(void)
+{
+	unsigned	active;
+	unsigned	bits;
+	int		i;
+
+	active = __atomic_load_n(&g_activeMask, __ATOMIC_ACQUIRE);
+	for (bits = active; bits; bits &= bits - 1)
+	{
+		i = __builtin_ctz(bits);
+		if (__atomic_load_n(&g_channeldone[i], __ATOMIC_ACQUIRE)
+			== __atomic_load_n(&g_channelgen[i], __ATOMIC_RELAXED))
+			active &= ~(1u << i);
+	}
+
+	return active;
+}
+
+// Active and not held by the pause
+static unsigned I_PlayingChannels(void)
+{
+	return I_ActiveChannels() & ~__atomic_load_n(&g_heldMask, __ATOMIC_ACQUIRE);
+}
+
+// Game thread only. The mixer may be in the channel, the
+//  new generation keeps it from writing back.
+static void I_ReleaseChannel(int slot)
+{
+	__atomic_and_fetch(&g_activeMask, ~(1u << slot), __ATOMIC_RELEASE);
+	__atomic_add_fetch(&g_channelgen[slot], 2, __ATOMIC_RELEASE);
+}
+
+
+//
+// Convert a DMX sound lump to the output rate and format.
+//
+static void I_CacheSfx(sfxcache_t* cache, byte* lump, int len)
+{
+	byte*		data;
+	long long	pos;
+	long long	step;
+	int		rate;
+	int		count;
+	int		i;
+	int		j;
+	int		a;
+	int		b;
+
+	// Header: format 3, sample rate and count, little endian
+	if (len < 8 || SHORT(((short*)lump)[0]) != 3)
+	{
+		fprintf(stderr, "I_CacheSfx: not a sound lump\n");
+		cache->length = 0;
+		return;
+	}
+
+	rate = (unsigned short) SHORT(((short*)lump)[1]);
+	count = LONG(((int*)lump)[1]);
+	data = lump + 8;
+
+	if (count > len - 8)
+		count = len - 8;
+	if (rate == 0)
+		rate = SAMPLERATE;
+
+	// DMX skips 16 bytes of padding either side
+	if (count > 48)
+	{
+		data += 16;
+		count -= 32;
+	}
+
+	cache->length = (long long) count * SAMPLERATE / rate;
+	cache->samples = malloc(cache->length * sizeof(short));
+	if (!cache->samples && cache->length)
+		I_Error("I_CacheSfx: out of memory");
+	cache->volumes[VOLBUCKETS-1] = cache->samples;
+	g_sfxcacheBytes += cache->length * sizeof(short);
 
-// Hardware left and right channel volume lookup.
-int*		channelleftvol_lookup[NUM_CHANNELS];
-int*		channelrightvol_lookup[NUM_CHANNELS];
+	// Resample linearly, unsigned 8 bit to signed 16 bit
+	step = ((long long) rate << 16) / SAMPLERATE;
+	for (i = 0, pos = 0; i < cache->length; i++, pos += step)
+	{
+		j = pos >> 16;
+		a = data[j];
+		b = j + 1 < count ? data[j + 1] : a;
+		cache->samples[i] = ((a - 128) << 8) + (((b - a) * (int)(pos & 0xffff)) >> 8);
+	}
+}
+
+
+//
+// The copy of a sound for a volume of 0 - 127. A sound that
+//  starts may make it, within SFXCOPYBYTES. Otherwise, and for
+//  volume changes while playing, the nearest copy there is.
+// Game thread only.
+//
+static short* I_SfxAtVolume(sfxcache_t* cache, int volume, boolean make)
+{
+	short*	copy;
+	int	bucket;
+	int	i;
+
+	bucket = (volume * (VOLBUCKETS-1) + 63) / 127;
+
+	if (cache->volumes[bucket])
+		return cache->volumes[bucket];
+
+	if (make
+		&& g_sfxcopyBytes + cache->length * sizeof(short) <= SFXCOPYBYTES)
+	{
+		copy = malloc(cache->length * sizeof(short));
+		if (copy)
+		{
+			g_sfxcopyBytes += cache->length * sizeof(short);
+			for (i = 0; i < cache->length; i++)
+				copy[i] = cache->samples[i] * bucket / (VOLBUCKETS-1);
+			cache->volumes[bucket] = copy;
+			return copy;
+		}
+	}
+
+	// Quieter first, the top bucket is there unless the sound
+	//  is empty
+	for (i = 1; i < VOLBUCKETS; i++)
+	{
+		if (bucket - i >= 0 && cache->volumes[bucket - i])
+			return cache->volumes[bucket - i];
+		if (bucket + i < VOLBUCKETS && cache->volumes[bucket + i])
+			return cache->volumes[bucket + i];
+	}
+
+	return cache->samples;
+}
+
+
+//
+// Set volume, separation and step of a channel.
+// Only a sound that starts makes new volume copies.
+//
+static void
+I_SetChannelParams
+( int		slot,
+  int		volume,
+  int		step,
+  int		seperation,
+  boolean	start )
+{
+	sfxcache_t*	sound;
+	int		rightvol;
+	int		leftvol;
+
+	if (g_stereo)
+	{
+		// Separation, that is, orientation/stereo.
+		//  range is: 1 - 256
+		seperation += 1;
+
+		// Per left/right channel.
+		//  x^2 seperation,
+		//  adjust volume properly.
+		leftvol =
+				volume - ((volume*seperation*seperation) >> 16); ///(256*256);
+		seperation = seperation - 257;
+		rightvol =
+				volume - ((volume*seperation*seperation) >> 16);
+	}
+	else
+	{
+		// Mono keeps the full volume
+		leftvol = volume;
+		rightvol = volume;
+	}
+
+	// Sanity check, clamp volume.
+	if (rightvol < 0 || rightvol > 127)
+		I_Error("rightvol out of bounds");
+
+	if (leftvol < 0 || leftvol > 127)
+		I_Error("leftvol out of bounds");
+
+	// The copies for these volume levels, the mixer
+	//  may be reading the channel already
+	sound = (sfxcache_t*) S_sfx[channelids[slot]].data;
+	__atomic_store_n(&channelleft[slot], I_SfxAtVolume(sound, leftvol, start), __ATOMIC_RELEASE);
+	__atomic_store_n(&channelright[slot], I_SfxAtVolume(sound, rightvol, start), __ATOMIC_RELEASE);
+
+	channelstep[slot] = step;
+}
 
 
 
@@ -156,26 +396,23 @@ void* getsfx(
 //  list of currently active sounds,
 //  which is maintained as a given number
 //  (eight, usually) of internal channels.
+// S_getChannel picked the channel, stopping
+//  what played there when voices ran out.
 // Returns a handle.
 //
 int addsfx(
 		int		sfxid,
+		int		slot,
 		int		volume,
 		int		step,
 		int		seperation )
 {
 	static unsigned short	handlenums = 0;
 
+	unsigned	active;
 	int		i;
 	int		rc = -1;
 
-	int		oldest = gametic;
-	int		oldestnum = 0;
-	int		slot;
-
-	int		rightvol;
-	int		leftvol;
-
 	// Chainsaw troubles.
 	// Play these sound effects only one at a time.
 	if ( sfxid == sfx_sawup
@@ -185,15 +422,16 @@ int addsfx(
 			|| sfxid == sfx_stnmov
 			|| sfxid == sfx_pistol	 )
 	{
-		// Loop all channels, check.
-		for (i=0 ; i<NUM_CHANNELS ; i++)
+		// Loop playing channels, check.
+		for (active = I_ActiveChannels(); active; active &= active - 1)
 		{
-			// Active, and using the same SFX?
-			if ( (channels[i])
-					&& (channelids[i] == sfxid) )
+			i = __builtin_ctz(active);
+
+			// Using the same SFX?
+			if (channelids[i] == sfxid)
 			{
 				// Reset.
-				channels[i] = 0;
+				I_ReleaseChannel(i);
 				// We are sure that iff,
 				//  there will only be one.
 				break;
@@ -201,32 +439,19 @@ int addsfx(
 		}
 	}
 
-	// Loop all channels to find oldest SFX.
-	for (i=0; (i<NUM_CHANNELS) && (channels[i]); i++)
-	{
-		if (channelstart[i] < oldest)
-		{
-			oldestnum = i;
-			oldest = channelstart[i];
-		}
-	}
+	if (slot < 0 || slot >= NUM_CHANNELS)
+		return -1;
 
-	// Tales from the cryptic.
-	// If we found a channel, fine.
-	// If not, we simply overwrite the first one, 0.
-	// Probably only happens at startup.
-	if (i == NUM_CHANNELS)
-		slot = oldestnum;
-	else
-		slot = i;
+	// S_StopChannel let it go already, unless
+	//  the sound it had is still playing
+	if (I_ActiveChannels() & (1u << slot))
+		I_ReleaseChannel(slot);
 
-	// Okay, in the less recent channel,
+	// Okay, in the channel given,
 	//  we will handle the new SFX.
-	// Set pointer to raw data.
-//	channels[slot] = (unsigned char *) S_sfx[sfxid].data;
-	// Set pointer to end of raw data.
-//	channelsend[slot] = channels[slot] + lengths[sfxid];
-	channelsend[slot] = (unsigned char *) S_sfx[sfxid].data + lengths[sfxid];
+	// Preserve sound SFX id,
+	//  e.g. for avoiding duplicates of chainsaw.
+	channelids[slot] = sfxid;
 
 	// Reset current handle number, limited to 0..100.
 	if (!handlenums)
@@ -236,49 +461,23 @@ int addsfx(
 	// Preserved so sounds could be stopped (unused).
 	channelhandles[slot] = rc = handlenums++;
 
-	// Set stepping???
-	// Kinda getting the impression this is never used.
-	channelstep[slot] = step;
-	// ???
-	channelstepremainder[slot] = 0;
 	// Should be gametic, I presume.
 	channelstart[slot] = gametic;
 
-#if 0 // No support for stereo for now
-	// Separation, that is, orientation/stereo.
-	//  range is: 1 - 256
-	seperation += 1;
-
-	// Per left/right channel.
-	//  x^2 seperation,
-	//  adjust volume properly.
-	leftvol =
-			volume - ((volume*seperation*seperation) >> 16); ///(256*256);
-	seperation = seperation - 257;
-	rightvol =
-			volume - ((volume*seperation*seperation) >> 16);
-#else
-	leftvol = volume;
-	rightvol = volume;
-#endif
-
-	// Sanity check, clamp volume.
-	if (rightvol < 0 || rightvol > 127)
-		I_Error("rightvol out of bounds");
-
-	if (leftvol < 0 || leftvol > 127)
-		I_Error("leftvol out of bounds");
+	// The mixer skips the channel while the generation is odd,
+	//  and starts it from the top once it changed.
+	__atomic_add_fetch(&g_channelgen[slot], 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
 
-	// Get the proper lookup table piece
-	//  for this volume level???
-	channelleftvol_lookup[slot] = &vol_lookup[leftvol*256];
-	channelrightvol_lookup[slot] = &vol_lookup[rightvol*256];
+	// Pitch is the step through the sound data.
+	I_SetChannelParams(slot, volume, step, seperation, true);
+	channels[slot] = (sfxcache_t *) S_sfx[sfxid].data;
 
-	// Preserve sound SFX id,
-	//  e.g. for avoiding duplicates of chainsaw.
-	channelids[slot] = sfxid;
+	__atomic_add_fetch(&g_channelgen[slot], 1, __ATOMIC_RELEASE);
 
-	channels[slot] = (unsigned char *) S_sfx[sfxid].data;
+	// Now the mixer may take it
+	__atomic_and_fetch(&g_heldMask, ~(1u << slot), __ATOMIC_RELEASE);
+	__atomic_or_fetch(&g_activeMask, 1u << slot, __ATOMIC_RELEASE);
 
 	// You tell me.
 	return rc;
@@ -303,7 +502,6 @@ void I_SetChannels()
 	// This function sets up internal lookups used during
 	//  the mixing process.
 	int		i;
-	int		j;
 
 	int*	steptablemid = steptable + 128;
 
@@ -317,14 +515,6 @@ void I_SetChannels()
 	// I fail to see that this is currently used.
 	for (i=-128 ; i<128 ; i++)
 		steptablemid[i] = (int)(pow(2.0, (i/64.0))*65536.0);
-
-
-	// Generates volume lookup tables
-	//  which also turn the unsigned samples
-	//  into signed samples.
-	for (i=0 ; i<128 ; i++)
-		for (j=0 ; j<256 ; j++)
-			vol_lookup[i*256+j] = (i*(j-128)*256)/127;
 }	
 
 
@@ -338,16 +528,6 @@ void I_SetSfxVolume(int volume)
 	snd_SfxVolume = volume;
 }
 
-// MUSIC API - dummy. Some code from DOS version.
-void I_SetMusicVolume(int volume)
-{
-	// Internal state variable.
-	snd_MusicVolume = volume;
-	// Now set volume on output device.
-	// Whatever( snd_MusciVolume );
-}
-
-
 //
 // Retrieve the raw data lump index
 //  for a given SFX name.
@@ -374,6 +554,7 @@ int I_GetSfxLumpNum(sfxinfo_t* sfx)
 int
 I_StartSound(
 		int		id,
+		int		channel,
 		int		vol,
 		int		sep,
 		int		pitch,
@@ -386,8 +567,12 @@ I_StartSound(
 	// Debug.
 	//fprintf( stderr, "starting sound %d", id );
 
+	// Recording devices start it at the current tic
+	I_MixToTic();
+
 	// Returns a handle (not used).
-	id = addsfx( id, vol, steptable[pitch], sep );
+	id = addsfx( id, channel, vol, steptable[pitch], sep );
+	I_WakeMixer();
 
 	//fprintf( stderr, "/handle is %d\n", id );
 
@@ -396,22 +581,57 @@ I_StartSound(
 
 
 
+//
+// Channel playing the sound of a handle, -1 when it is done.
+//
+static int I_ChannelForHandle(int handle)
+{
+	unsigned	active;
+	int		i;
+
+	for (active = I_ActiveChannels(); active; active &= active - 1)
+	{
+		i = __builtin_ctz(active);
+		if (channelhandles[i] == handle)
+			return i;
+	}
+
+	return -1;
+}
+
+
 void I_StopSound (int handle)
 {
-	// You need the handle returned by StartSound.
-	// Would be looping all channels,
-	//  tracking down the handle,
-	//  an setting the channel to zero.
+	int slot;
+
+	I_MixToTic();
 
-	// UNUSED.
-	handle = 0;
+	slot = I_ChannelForHandle(handle);
+	if (slot >= 0)
+		I_ReleaseChannel(slot);
 }
 
 
 int I_SoundIsPlaying(int handle)
 {
-	// Ouch.
-	return gametic < handle;
+	return I_ChannelForHandle(handle) >= 0;
+}
+
+
+//
+// The game is paused, hold the sound effects.
+//
+void I_PauseSound(void)
+{
+	I_MixToTic();
+	__atomic_store_n(&g_heldMask, I_ActiveChannels(), __ATOMIC_RELEASE);
+}
+
+void I_ResumeSound(void)
+{
+	I_MixToTic();
+	__atomic_store_n(&g_heldMask, 0, __ATOMIC_RELEASE);
+	I_WakeMixer();
 }
 
 
@@ -432,146 +652,544 @@ int I_SoundIsPlaying(int handle)
 //
 void I_UpdateSound( void )
 {
+	I_MixToTic();
 }
 
 
 
-void* audioThreadMain(void* arg)
+//
+// Audio devices, the first one is the default.
+//
+static snddev_t* g_snddevs[] =
 {
-	mraa_pwm_context pwm;
-	pwm = mraa_pwm_init(PWM_ARDUINO_PIN);
-	if (pwm == NULL) {
-		fprintf(stderr, "Cannot open PWM pin %d\n", PWM_ARDUINO_PIN);
-		return 0;
-	}
+#ifndef NOMRAA
+	&pwmsnddev,
+#endif
+	&nullsnddev,
+	&wavsnddev
+};
 
-	mraa_pwm_period_us(pwm, PWM_PERIOD_USEC);
-	//mraa_pwm_write_period(pwm, PWM_PERIOD_USEC * 1000);
-	mraa_pwm_enable(pwm, 1);
+#define NUMSNDDEVS (sizeof(g_snddevs) / sizeof(g_snddevs[0]))
 
-	char bu[64];
-	snprintf(bu, sizeof(bu), "/sys/class/pwm/pwmchip%d/pwm%d/duty_cycle", PWM_CHIP_ID, PWM_PIN);
-	int duty_fp = open(bu, O_RDWR);
-	if (duty_fp == -1) {
-		fprintf(stderr, "Cannot open PWM duty file %s\n", bu);
-		return 0;
+static snddev_t* g_snddev = NULL;
+
+
+//
+// For snd_realtime devices mixing runs in blocks on its own
+//  thread, into a ring of mixed samples. The output thread takes
+//  them from the ring one at a time at SAMPLERATE. The ring has a
+//  single producer and a single consumer, each of which only writes
+//  its own index, so it needs no lock.
+//
+
+// Samples mixed per pass of the mixer thread
+#define MIXBLOCK		256
+
+// Samples the mixer keeps queued ahead of the output, the latency
+#define MIXLEAD			(2*MIXBLOCK)
+
+// Ring size in output samples, a power of two above
+//  (MIXLEAD + MIXBLOCK) * MAXOVERSAMPLE
+#define RINGSIZE		4096
+
+static short		g_ring[RINGSIZE][2];
+static unsigned		g_ringHead;	// Next sample to mix, mixer thread
+static unsigned		g_ringTail;	// Next sample to play, output thread
+
+static pthread_t	g_mixerThread;
+static pthread_t	g_outputThread;
+static boolean		g_mixerRunning;
+static boolean		g_outputRunning;
+
+// Set by I_ShutdownSound, the threads exit
+static volatile boolean	g_soundQuit;
+
+// The realtime threads sleep here while nothing plays
+static pthread_mutex_t	g_idleLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	g_idleCond = PTHREAD_COND_INITIALIZER;
+
+// -sndcpu, the core of the audio threads, -1 for any
+static int		g_soundCpu = 1;
+
+// -sndprio, SCHED_FIFO priority of the output thread, the
+//  mixer runs one below. 0 for normal scheduling.
+static int		g_soundPriority;
+
+// snd_gametic: samples mixed so far
+static long long	g_mixedSamples;
+
+// snd_freerun: mixing time by number of active channels
+static long long	g_mixNanos[NUM_CHANNELS+1];
+static long long	g_mixBlocks[NUM_CHANNELS+1];
+
+// -sndstats, the mixer and output threads each write
+//  their own counters
+static boolean		g_statsOn;
+static sndstats_t	g_stats;
+
+static int I_RingQueued(void)
+{
+	return __atomic_load_n(&g_ringHead, __ATOMIC_ACQUIRE)
+		- __atomic_load_n(&g_ringTail, __ATOMIC_ACQUIRE);
+}
+
+static void I_AddNanos(struct timespec* t, long long ns)
+{
+	ns += t->tv_nsec;
+	t->tv_sec += ns / 1000000000LL;
+	t->tv_nsec = ns % 1000000000LL;
+}
+
+static long long I_NanosSince(struct timespec* t)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - t->tv_sec) * 1000000000LL + now.tv_nsec - t->tv_nsec;
+}
+
+//
+// Keep the longest time since the last read and overall.
+//
+static void I_RecordPeak(int* peak, int* max, long long nanos)
+{
+	if (nanos > __atomic_load_n(peak, __ATOMIC_RELAXED))
+		__atomic_store_n(peak, nanos, __ATOMIC_RELAXED);
+	if (nanos > *max)
+		*max = nanos;
+}
+
+//
+// Bin how late the output woke up for a sample.
+//
+static void I_RecordLate(long long late, long long rate)
+{
+	int bin;
+
+	late *= rate;
+	if (late < 100000000LL)
+		bin = 0;
+	else if (late < 500000000LL)
+		bin = 1;
+	else if (late < 1000000000LL)
+		bin = 2;
+	else if (late < 2000000000LL)
+		bin = 3;
+	else if (late < 8000000000LL)
+		bin = 4;
+	else
+		bin = 5;
+
+	g_stats.late[bin]++;
+}
+
+// Block being mixed, left and right interleaved
+static int		g_mixbuffer[MIXBLOCK*2];
+
+// snd_realtime: output samples per mixed sample, -oversample
+#define MAXOVERSAMPLE		4
+static int		g_oversample = 1;
+
+//
+// Mix count samples of all active channels. Each channel is
+//  added to the whole block in one pass, stereo adds left and
+//  right side by side, so the inner loop stays short and in
+//  cache. Stereo output is interleaved.
+// The sounds are at the output rate and already attenuated, so
+//  an unpitched channel is a plain add the compiler vectorizes.
+// Returns the number of samples for the device, count times
+//  the oversampling.
+//
+static int I_MixSamples(short* out, int count)
+{
+	struct timespec	start;
+	short*		left;
+	short*		right;
+	unsigned int	step;
+	unsigned int	remainder;
+	int*		mix;
+	unsigned	active;
+	unsigned	gen;
+	sfxcache_t*	sound;
+	int		length;
+	int		pos;
+	int		chan;
+	int		n;
+	int		i;
+	long long	nanos;
+
+	if (g_statsOn)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		g_stats.voices = __builtin_popcount(I_ActiveChannels());
 	}
 
-	double startTime = 0;
-	while (1)
+	memset(g_mixbuffer, 0, count * 2 * sizeof(int));
+
+	// Only the playing channels
+	for (active = I_PlayingChannels(); active; active &= active - 1)
 	{
-		struct timespec t;
-		clock_gettime(CLOCK_REALTIME, &t);
-		double time = (double)t.tv_sec + (double)t.tv_nsec / 1.0e9;
+		chan = __builtin_ctz(active);
+
+		// The game thread may be starting another sound here,
+		//  read the channel between two equal generations.
+		gen = __atomic_load_n(&g_channelgen[ chan ], __ATOMIC_ACQUIRE);
+		if (gen & 1)
+			continue;
+
+		sound = channels[ chan ];
+		step = channelstep[ chan ];
+		left = __atomic_load_n(&channelleft[ chan ], __ATOMIC_ACQUIRE);
+		right = __atomic_load_n(&channelright[ chan ], __ATOMIC_ACQUIRE);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&g_channelgen[ chan ], __ATOMIC_RELAXED) != gen
+			|| !sound)
+			continue;
+
+		// A new sound plays from the start
+		if (g_mixgen[ chan ] != gen)
+		{
+			g_mixgen[ chan ] = gen;
+			channelpos[ chan ] = 0;
+			channelstepremainder[ chan ] = 0;
+		}
 
-		if (startTime == 0)
-			startTime = time;
+		pos = channelpos[ chan ];
+		remainder = channelstepremainder[ chan ];
+		length = sound->length;
+		mix = g_mixbuffer;
 
-		double sampleIndex = (time - startTime) * SAMPLERATE;
+		if (step == 65536)
+		{
+			n = length - pos;
+			if (n > count)
+				n = count;
 
-		static int lastPlayedSample = 0;
-		if (lastPlayedSample != (int)sampleIndex)
+			left += pos;
+			right += pos;
+			if (g_stereo)
+			{
+				for (i = 0; i < n; i++)
+				{
+					mix[2*i] += left[i];
+					mix[2*i+1] += right[i];
+				}
+			}
+			else
+			{
+				for (i = 0; i < n; i++)
+					mix[i] += left[i];
+			}
+			pos += n;
+		}
+		else if (g_stereo)
 		{
-			lastPlayedSample = (int)sampleIndex;
-
-#ifdef SNDTIMINGDEBUG
-			static int samplesPlayed = 0;
-			static double lastTime = 0;
-			static double samplesTooLate = 0.0;
-			static double maxSampleTooLate = 0.0;
-			static int numLateSamples = 0;
-
-			samplesPlayed++;
-			// Timing error measurement: How far into the sample are we already?
-			double sampleTooLate = sampleIndex - (int)sampleIndex;
-			samplesTooLate += sampleTooLate;
-			if (sampleTooLate > maxSampleTooLate)
-				maxSampleTooLate = sampleTooLate;
-			if (sampleTooLate > 0.1)
-				numLateSamples++;
-
-			if (time - lastTime > 10.0)
+			for (i = count; i && pos < length; i--)
 			{
-				printf("%f samples per second, timing precision: avg %f, max %f, late %f%%\n",
-						samplesPlayed / (time - lastTime),
-						samplesTooLate / samplesPlayed, maxSampleTooLate,
-						100.0 * numLateSamples / samplesPlayed);
-				lastTime = time;
-				samplesPlayed = 0;
-				samplesTooLate = 0.0;
-				maxSampleTooLate = 0.0;
-				numLateSamples = 0;
+				mix[0] += left[pos];
+				mix[1] += right[pos];
+				mix += 2;
+
+				// MSB is next sample, keep the fraction
+				remainder += step;
+				pos += remainder >> 16;
+				remainder &= 65536-1;
 			}
-#endif
+		}
+		else
+		{
+			for (i = count; i && pos < length; i--)
+			{
+				*mix++ += left[pos];
 
+				remainder += step;
+				pos += remainder >> 16;
+				remainder &= 65536-1;
+			}
+		}
+
+		channelstepremainder[ chan ] = remainder;
+		channelpos[ chan ] = pos;
+
+		// Check whether we are done.
+		if (pos >= length)
+			__atomic_store_n(&g_channeldone[ chan ], gen, __ATOMIC_RELEASE);
+	}
 
-			//float value = audioData[(int)sampleIndex % sizeof(audioData)] / 255.0f;
-			//value = sin(time*hertz * 6.28) * 0.5 + 0.5;
+	I_MixMusic(g_mixbuffer, count, g_stereo, g_snddev->clock != snd_gametic);
 
-			// Mix current sound data.
-			// Data, from raw sound, for right and left.
-			unsigned int	sample;
-			int		dl = 0;
+	// Gain, limit and quantize for the device
+	n = I_ShapeOutput(g_mixbuffer, out, count);
 
-			// Mixing channel index.
-			int				chan;
+	if (g_statsOn)
+	{
+		nanos = I_NanosSince(&start);
+		g_stats.mixBlocks++;
+		g_stats.mixNanos += nanos;
+		g_stats.voiceBlocks += g_stats.voices;
+		I_RecordPeak(&g_stats.mixPeakNanos, &g_stats.mixMaxNanos, nanos);
+	}
+
+	return n;
+}
+
+//
+// Nothing to mix: no sound effect playing, other than held
+//  by the pause, and no music.
+//
+static boolean I_SoundSilent(void)
+{
+	return !I_PlayingChannels() && !I_MusicActive();
+}
+
+//
+// snd_realtime: sleep until something plays. Returns whether
+//  it slept.
+//
+static boolean I_WaitForSound(void)
+{
+	boolean slept = false;
+
+	pthread_mutex_lock(&g_idleLock);
+	while (!g_soundQuit && I_SoundSilent())
+	{
+		pthread_cond_wait(&g_idleCond, &g_idleLock);
+		slept = true;
+	}
+	pthread_mutex_unlock(&g_idleLock);
+
+	return slept;
+}
+
+//
+// Something may play now, or the threads have to quit.
+//
+void I_WakeMixer(void)
+{
+	if (!g_outputRunning)
+		return;
+
+	pthread_mutex_lock(&g_idleLock);
+	pthread_cond_broadcast(&g_idleCond);
+	pthread_mutex_unlock(&g_idleLock);
+}
+
+//
+// Pin an audio thread to -sndcpu and give it a SCHED_FIFO priority.
+//
+static void I_SetupAudioThread(char* name, int priority)
+{
+	struct sched_param	param;
+	cpu_set_t		cpus;
+	int			err;
+
+	if (g_soundCpu >= 0 && g_soundCpu < sysconf(_SC_NPROCESSORS_ONLN))
+	{
+		CPU_ZERO(&cpus);
+		CPU_SET(g_soundCpu, &cpus);
+		err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (err != 0)
+			fprintf(stderr, "I_InitSound: %s thread not on CPU %d: %s\n", name, g_soundCpu, strerror(err));
+	}
 
-			// Love thy L2 chache - made this a loop.
-			// Now more channels could be set at compile time
-			//  as well. Thus loop those  channels.
-			for (chan = 0; chan < NUM_CHANNELS; chan++ )
+	if (priority > 0)
+	{
+		param.sched_priority = priority;
+		err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (err != 0)
+			fprintf(stderr, "I_InitSound: no SCHED_FIFO for audio %s: %s\n", name, strerror(err));
+	}
+}
+
+//
+// snd_realtime: keeps MIXLEAD samples queued, mixing MIXBLOCK at a time,
+//  the ring counts them after oversampling. Sleeps when silent and
+//  the output has played everything.
+// snd_freerun: mixes and writes blocks as fast as it can.
+//
+static void* I_MixerThread(void* arg)
+{
+	struct timespec	next;
+	struct timespec	now;
+	short		block[MIXBLOCK*2*MAXOVERSAMPLE];
+	unsigned	head;
+	int		active;
+	int		count;
+	int		i;
+
+	if (g_snddev->clock == snd_freerun)
+	{
+		while (!g_soundQuit)
+		{
+			active = __builtin_popcount(I_ActiveChannels());
+
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			I_MixSamples(block, MIXBLOCK);
+			g_mixNanos[active] += I_NanosSince(&now);
+			g_mixBlocks[active]++;
+
+			g_snddev->Write(block, MIXBLOCK);
+		}
+		return 0;
+	}
+
+	I_SetupAudioThread("mixer", g_soundPriority - 1);
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	while (!g_soundQuit)
+	{
+		if (I_SoundSilent() && !I_RingQueued())
+		{
+			if (I_WaitForSound())
+				clock_gettime(CLOCK_MONOTONIC, &next);
+			continue;
+		}
+
+		while (!I_SoundSilent() && I_RingQueued() <= (MIXLEAD - MIXBLOCK) * g_oversample)
+		{
+			count = I_MixSamples(block, MIXBLOCK);
+
+			head = g_ringHead;
+			for (i = 0; i < count; i++)
 			{
-				// Check channel, if active.
-				if (channels[ chan ])
+				short* frame = g_ring[(head + i) & (RINGSIZE - 1)];
+				if (g_stereo)
 				{
-					// Get the raw data from the channel.
-					sample = *channels[ chan ];
-					// Add left and right part
-					//  for this channel (sound)
-					//  to the current data.
-					// Adjust volume accordingly.
-					dl += channelleftvol_lookup[ chan ][sample];
-					// Increment index ???
-					channelstepremainder[ chan ] += channelstep[ chan ];
-					// MSB is next sample???
-					channels[ chan ] += channelstepremainder[ chan ] >> 16;
-					// Limit to LSB???
-					channelstepremainder[ chan ] &= 65536-1;
-
-					// Check whether we are done.
-					if (channels[ chan ] >= channelsend[ chan ])
-						channels[ chan ] = 0;
+					frame[0] = block[i*2];
+					frame[1] = block[i*2+1];
 				}
+				else
+					frame[0] = block[i];
 			}
+			__atomic_store_n(&g_ringHead, head + count, __ATOMIC_RELEASE);
+		}
 
-			dl *= 8; // PWM has very limited bit resolution, make sounds louder to use more of the available range...
+		// The output takes a block in this time. Start again
+		//  from now when far behind, rather than spinning to catch up.
+		I_AddNanos(&next, MIXBLOCK * 1000000000LL / SAMPLERATE);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (now.tv_sec > next.tv_sec + 1)
+			next = now;
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
 
-			// Clamp to range. Left hardware channel.
-			float value;
-			if (dl > 0x7fff)
-				value = 1.0f;
-			else if (dl < -0x8000)
-				value = 0.0f;
-			else
-				value = (float)dl / 0x10000 + 0.5f;
-
-			//mraa_pwm_write(pwm, value);
-			//mraa_pwm_pulsewidth_us(pwm, (int) (value * PWM_PERIOD_USEC));
-		    int length = snprintf(bu, sizeof(bu), "%d", (int)(value * (PWM_PERIOD_USEC * 1000)));
-		    if (write(duty_fp, bu, length * sizeof(char)) == -1)
-		    {
-		    	fprintf(stderr, "PWM duty write failure\n");
-		    }
-
-			// usleep sleeps to long, need to investigate kernel scheduler (maybe SCHED_FIFO?)
-			//usleep(1000000 / SAMPLERATE);
-			//usleep(1);
+	return 0;
+}
+
+//
+// snd_realtime: plays the ring one sample per period
+//  against absolute deadlines, g_oversample times per
+//  mixed sample. Sleeps when silent and the ring is empty.
+//
+static void* I_OutputThread(void* arg)
+{
+	struct timespec		start;
+	struct timespec		next;
+	struct timespec		written;
+	long long		played;
+	long long		nanos;
+	short			silence[2] = { 0, 0 };
+	short*			frame;
+	boolean			queued;
+	boolean			waking;
+	long long		rate = SAMPLERATE * g_oversample;
+
+	// Sample timing has to beat the game threads to the CPU
+	I_SetupAudioThread("output", g_soundPriority);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	played = 0;
+	waking = true;
+
+	while (!g_soundQuit)
+	{
+		if (!I_RingQueued() && I_SoundSilent())
+		{
+			// Hold the center level until something plays,
+			//  the first mix is not an underrun
+			g_snddev->Write(silence, 1);
+			if (I_WaitForSound())
+			{
+				clock_gettime(CLOCK_MONOTONIC, &start);
+				played = 0;
+				waking = true;
+			}
+			continue;
+		}
+
+		// Deadlines from the start, so rounding does not add up
+		next = start;
+		I_AddNanos(&next, ++played * 1000000000LL / rate);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		if (g_statsOn)
+		{
+			I_RecordLate(I_NanosSince(&next), rate);
+			g_stats.samples++;
+		}
+
+		queued = I_RingQueued() > 0;
+		if (queued)
+		{
+			frame = g_ring[g_ringTail & (RINGSIZE - 1)];
+			waking = false;
+		}
+		else
+		{
+			// Nothing mixed in time, hold the center level
+			frame = silence;
+			if (g_statsOn && !waking)
+				g_stats.underruns++;
+		}
+
+		if (g_statsOn)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &written);
+			g_snddev->Write(frame, 1);
+			nanos = I_NanosSince(&written);
+			g_stats.writeNanos += nanos;
+			I_RecordPeak(&g_stats.writePeakNanos, &g_stats.writeMaxNanos, nanos);
+		}
+		else
+		{
+			g_snddev->Write(frame, 1);
 		}
+
+		if (queued)
+			__atomic_store_n(&g_ringTail, g_ringTail + 1, __ATOMIC_RELEASE);
 	}
 
 	return 0;
 }
 
+//
+// snd_gametic: mix up to the start of the current tic. Called
+//  every frame, and before channels change so sounds start
+//  on the sample of their tic.
+//
+static void I_MixToTic(void)
+{
+	short		block[MIXBLOCK*2];
+	long long	target;
+	int		count;
+
+	if (!g_snddev || g_snddev->clock != snd_gametic)
+		return;
+
+	target = (long long)gametic * SAMPLERATE / TICRATE;
+	while (g_mixedSamples < target)
+	{
+		count = target - g_mixedSamples;
+		if (count > MIXBLOCK)
+			count = MIXBLOCK;
+
+		I_MixSamples(block, count);
+		g_snddev->Write(block, count);
+		g_mixedSamples += count;
+	}
+}
+
 // 
 // This would be used to write out the mixbuffer
 //  during each game loop update.
@@ -594,42 +1212,109 @@ I_UpdateSoundParams(
 		int	sep,
 		int	pitch)
 {
-	// I fail too see that this is used.
-	// Would be using the handle to identify
-	//  on which channel the sound might be active,
-	//  and resetting the channel parameters.
+	int slot;
 
-	// UNUSED.
-	handle = vol = sep = pitch = 0;
+	// Moving sounds change from their tic on
+	I_MixToTic();
+
+	// S_UpdateSounds passes the unvaried pitch, keep the
+	//  step the sound started with
+	slot = I_ChannelForHandle(handle);
+	if (slot >= 0)
+		I_SetChannelParams(slot, vol, channelstep[slot], sep, false);
 }
 
 
 
 
+//
+// Audio telemetry.
+//
+boolean I_ReadSoundStats(sndstats_t* stats)
+{
+	if (!g_statsOn || !g_snddev)
+		return false;
+
+	*stats = g_stats;
+	stats->musicVoices = I_MusicVoices();
+
+	__atomic_store_n(&g_stats.mixPeakNanos, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&g_stats.writePeakNanos, 0, __ATOMIC_RELAXED);
+
+	return true;
+}
+
+static void I_PrintSoundStats(void)
+{
+	static const char* bins[SNDLATEBINS] =
+	{
+		"<0.1", "<0.5", "<1", "<2", "<8", "more"
+	};
+	int i;
+
+	fprintf(stderr, "I_ShutdownSound: audio telemetry\n");
+
+	if (g_stats.mixBlocks)
+	{
+		fprintf(stderr, "  mixing: %lld blocks, avg %.1f us, max %.1f us, %.1f voices on average\n",
+				g_stats.mixBlocks,
+				g_stats.mixNanos / (g_stats.mixBlocks * 1000.0),
+				g_stats.mixMaxNanos / 1000.0,
+				(double)g_stats.voiceBlocks / g_stats.mixBlocks);
+	}
+
+	if (g_stats.samples)
+	{
+		fprintf(stderr, "  output: %lld samples, %d underruns, write avg %.1f us, max %.1f us\n",
+				g_stats.samples, g_stats.underruns,
+				g_stats.writeNanos / (g_stats.samples * 1000.0),
+				g_stats.writeMaxNanos / 1000.0);
+
+		fprintf(stderr, "  late by sample periods:");
+		for (i = 0; i < SNDLATEBINS; i++)
+			fprintf(stderr, " %s %d", bins[i], g_stats.late[i]);
+		fprintf(stderr, "\n");
+	}
+}
+
+
 void I_ShutdownSound(void)
 {    
-	// Wait till all pending sounds are finished.
-	int done = 0;
 	int i;
 
+	if (!g_snddev)
+		return;
 
-	// FIXME (below).
-	fprintf( stderr, "I_ShutdownSound: NOT finishing pending sounds\n");
-	fflush( stderr );
-
-	while ( !done )
+	// Wait till the pending sounds are played, a second at most
+	if (g_outputRunning)
 	{
-		for( i=0 ; i<8 && !channels[i] ; i++);
+		for (i = 0; i < 100 && (I_PlayingChannels() || I_RingQueued()); i++)
+			usleep(10000);
+	}
 
-		// FIXME. No proper channel output.
-		//if (i==8)
-		done=1;
+	g_soundQuit = true;
+	I_WakeMixer();
+	if (g_outputRunning)
+		pthread_join(g_outputThread, NULL);
+	if (g_mixerRunning)
+		pthread_join(g_mixerThread, NULL);
+
+	if (g_snddev->clock == snd_freerun)
+	{
+		fprintf(stderr, "I_ShutdownSound: mixing time per sample by active channels\n");
+		for (i = 0; i <= NUM_CHANNELS; i++)
+		{
+			if (g_mixBlocks[i])
+				fprintf(stderr, "  %d: %6.1f ns (%lld blocks)\n", i,
+						(double)g_mixNanos[i] / (g_mixBlocks[i] * MIXBLOCK), g_mixBlocks[i]);
+		}
 	}
 
-	// TODO: Clean up audio thread.
+	if (g_statsOn)
+		I_PrintSoundStats();
 
-	// Done.
-	return;
+	g_snddev->Shutdown();
+	g_snddev = NULL;
 }
 
 
@@ -640,7 +1325,11 @@ void I_ShutdownSound(void)
 void
 I_InitSound()
 { 
+	byte* lump;
+	int len;
 	int i;
+	int p;
+	int err;
 
 	// Secure and configure sound device first.
 	fprintf( stderr, "I_InitSound: ");
@@ -651,15 +1340,93 @@ I_InitSound()
 		channels[i] = 0;
 	}
 
-	pthread_t audioThread = 0;
-	int err = pthread_create(&audioThread, NULL, &audioThreadMain, NULL);
-	if (err != 0)
-		fprintf(stderr, "Can't create audio thread: %s\n", strerror(err));
+	// -audio <name> picks the device, the first one by default
+	g_snddev = g_snddevs[0];
+	p = M_CheckParm("-audio");
+	if (p && p < myargc-1)
+	{
+		g_snddev = NULL;
+		for (i = 0; i < NUMSNDDEVS; i++)
+		{
+			if (!strcasecmp(g_snddevs[i]->name, myargv[p+1]))
+				g_snddev = g_snddevs[i];
+		}
+		if (!g_snddev)
+			I_Error("Unknown audio device %s", myargv[p+1]);
+	}
+#ifdef NOMRAA
+	else
+	{
+		// Nothing to play on, and the null device would
+		//  use up a core
+		g_snddev = NULL;
+	}
+#endif
 
-	fprintf(stderr, " configured audio device\n" );
+	if (g_snddev && !g_snddev->Init())
+	{
+		g_snddev->Shutdown();
+		g_snddev = NULL;
+	}
 
+	if (!g_snddev)
+	{
+		fprintf(stderr, " no audio device\n" );
+	}
+	else
+	{
+		g_soundQuit = false;
+		g_mixedSamples = 0;
+		g_stereo = g_snddev->stereo;
+
+		// -oversample 2 or 4 plays faster than mixing, where the
+		//  output is paced
+		g_oversample = 1;
+		p = M_CheckParm("-oversample");
+		if (p && p < myargc-1 && g_snddev->clock == snd_realtime)
+		{
+			g_oversample = atoi(myargv[p+1]);
+			if (g_oversample != 2 && g_oversample != MAXOVERSAMPLE)
+				g_oversample = 1;
+		}
+		I_InitShaping(g_snddev->bits, g_oversample, g_stereo);
+
+		memset(&g_stats, 0, sizeof(g_stats));
+		g_statsOn = M_CheckParm("-sndstats") != 0;
+
+		p = M_CheckParm("-sndcpu");
+		if (p && p < myargc-1)
+			g_soundCpu = atoi(myargv[p+1]);
 
-	// Initialize external data (all sounds) at start, keep static.
+		g_soundPriority = sched_get_priority_max(SCHED_FIFO);
+		p = M_CheckParm("-sndprio");
+		if (p && p < myargc-1)
+			g_soundPriority = atoi(myargv[p+1]);
+		if (g_soundPriority > sched_get_priority_max(SCHED_FIFO))
+			g_soundPriority = sched_get_priority_max(SCHED_FIFO);
+		if (g_soundPriority < 0)
+			g_soundPriority = 0;
+
+		if (g_snddev->clock != snd_gametic)
+		{
+			err = pthread_create(&g_mixerThread, NULL, &I_MixerThread, NULL);
+			if (err != 0)
+				fprintf(stderr, "Can't create mixer thread: %s\n", strerror(err));
+			g_mixerRunning = !err;
+		}
+		if (g_snddev->clock == snd_realtime)
+		{
+			err = pthread_create(&g_outputThread, NULL, &I_OutputThread, NULL);
+			if (err != 0)
+				fprintf(stderr, "Can't create audio output thread: %s\n", strerror(err));
+			g_outputRunning = !err;
+		}
+
+		fprintf(stderr, " configured %s audio device\n", g_snddev->name);
+	}
+
+
+	// Convert all sounds at start, keep static.
 	fprintf( stderr, "I_InitSound: ");
 
 	for (i=1 ; i<NUMSFX ; i++)
@@ -667,83 +1434,23 @@ I_InitSound()
 		// Alias? Example is the chaingun sound linked to pistol.
 		if (!S_sfx[i].link)
 		{
-			// Load data from WAD file.
-			S_sfx[i].data = getsfx( S_sfx[i].name, &lengths[i] );
+			// Load data from WAD file, the zone may
+			//  have it back once converted.
+			lump = getsfx( S_sfx[i].name, &len );
+			I_CacheSfx(&g_sfxcache[i], lump, len);
+			Z_ChangeTag(lump, PU_CACHE);
+
+			S_sfx[i].data = &g_sfxcache[i];
 		}
 		else
 		{
 			// Previously loaded already?
-			S_sfx[i].data = S_sfx[i].link->data;
-			lengths[i] = lengths[(S_sfx[i].link - S_sfx)/sizeof(sfxinfo_t)];
+			S_sfx[i].data = &g_sfxcache[S_sfx[i].link - S_sfx];
 		}
 	}
 
-	fprintf( stderr, " pre-cached all sound data\n");
+	fprintf( stderr, " pre-cached all sound data, %d KB\n", g_sfxcacheBytes >> 10);
 
 	// Finished initialization.
 	fprintf(stderr, "I_InitSound: sound module ready\n");
 }
-
-
-
-
-//
-// MUSIC API.
-// Still no music done.
-// Remains. Dummies.
-//
-void I_InitMusic(void)		{ }
-void I_ShutdownMusic(void)	{ }
-
-static int	looping=0;
-static int	musicdies=-1;
-
-void I_PlaySong(int handle, int looping)
-{
-	// UNUSED.
-	handle = looping = 0;
-	musicdies = gametic + TICRATE*30;
-}
-
-void I_PauseSong (int handle)
-{
-	// UNUSED.
-	handle = 0;
-}
-
-void I_ResumeSong (int handle)
-{
-	// UNUSED.
-	handle = 0;
-}
-
-void I_StopSong(int handle)
-{
-	// UNUSED.
-	handle = 0;
-
-	looping = 0;
-	musicdies = 0;
-}
-
-void I_UnRegisterSong(int handle)
-{
-	// UNUSED.
-	handle = 0;
-}
-
-int I_RegisterSong(void* data)
-{
-	// UNUSED.
-	data = NULL;
-
-	return 1;
-}
-
-// Is the song playing?
-int I_QrySongPlaying(int handle)
-{
-	// UNUSED.
-	handle = 0;
-	return looping || musicdies > gametic;
-}
@@ -37,6 +37,11 @@ extern char* sndserver_filename;
 
 
 
+// Most sounds playing at once, snd_channels or -voices
+//  set how many are used.
+#define MAXVOICES	32
+
+
 // Init at program start...
 void I_InitSound();
 
@@ -47,6 +52,43 @@ void I_SubmitSound(void);
 // ... shut down and relase at program termination.
 void I_ShutdownSound(void);
 
+// Game PAUSE holds the sound effects where they are.
+void I_PauseSound(void);
+void I_ResumeSound(void);
+
+
+//
+// Audio timing telemetry, collected with -sndstats.
+//
+
+// Output wakeups by how late they are, in sample periods:
+//  under 0.1, 0.5, 1, 2, 8, and more.
+#define SNDLATEBINS	6
+
+typedef struct
+{
+    long long	samples;		// Played by the output thread
+    int		underruns;		// Nothing mixed in time
+    int		late[SNDLATEBINS];
+
+    long long	mixBlocks;		// Mixed, on any thread
+    long long	mixNanos;
+    int		mixPeakNanos;		// Longest since the last read
+    int		mixMaxNanos;
+    long long	voiceBlocks;		// Sum of voices over blocks
+    int		voices;			// Sound effects, last block
+    int		musicVoices;		// Notes sounding now
+
+    long long	writeNanos;		// In the device Write of the
+    int		writePeakNanos;		//  output thread
+    int		writeMaxNanos;
+
+} sndstats_t;
+
+// Copies the counters and restarts the peaks,
+//  false without -sndstats.
+boolean I_ReadSoundStats(sndstats_t* stats);
+
 
 //
 //  SFX I/O
@@ -59,10 +101,12 @@ void I_SetChannels();
 int I_GetSfxLumpNum (sfxinfo_t* sfxinfo );
 
 
-// Starts a sound in a particular sound channel.
+// Starts a sound in a particular sound channel,
+//  0 to snd_channels-1, as S_getChannel picks them.
 int
 I_StartSound
 ( int		id,
+  int		channel,
   int		vol,
   int		sep,
   int		pitch,
@@ -30,35 +30,16 @@ rcsid[] = "$Id: m_bbox.c,v 1.1 1997/02/03 22:45:10 b1 Exp $";
 
 #include <stdarg.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
-#include <fcntl.h>
-#include <linux/input.h>
-
-// Undef name collisions between input.h and doomdef.h, can't map these without some trickery
-#undef KEY_ENTER
-#undef KEY_TAB
-#undef KEY_F1
-#undef KEY_F2
-#undef KEY_F3
-#undef KEY_F4
-#undef KEY_F5
-#undef KEY_F6
-#undef KEY_F7
-#undef KEY_F8
-#undef KEY_F9
-#undef KEY_F10
-#undef KEY_F11
-#undef KEY_F12
-#undef KEY_BACKSPACE
-#undef KEY_PAUSE
-#undef KEY_EQUALS
-#undef KEY_MINUS
-
 #include "doomdef.h"
+#include "m_argv.h"
 #include "m_misc.h"
+#include "i_prof.h"
 #include "i_video.h"
 #include "i_sound.h"
+#include "i_input.h"
 
 #include "d_net.h"
 #include "d_main.h"
@@ -70,8 +51,37 @@ rcsid[] = "$Id: m_bbox.c,v 1.1 1997/02/03 22:45:10 b1 Exp $";
 #include "i_system.h"
 
 
-const char* g_gamepadName = "/dev/input/event2";
-int g_gamepad = -1;
+// Frame pacing, -fps <n>. At TICRATE and above TryRunTics paces the
+// loop by sleeping until the next tic, below it I_WaitFrame does.
+// Interpolating, I_WaitFrame paces at any rate, 2*TICRATE by default.
+static int g_targetFps = TICRATE;
+
+// -interpolate, frames are drawn between tics
+boolean g_interpolate;
+static long g_frameNanos;
+static struct timespec g_frameDeadline;
+
+// -frameskip, the loop runs every tic and D_Display is left out
+// when drawing would make the game late. -fps is then the most
+// frames drawn a second rather than the loop pacing.
+static boolean g_frameSkip;
+
+// -maxskip <n>, frames left out in a row under load at most
+static int g_maxSkip = 3;
+
+// -lagbudget <ms>, how late a frame may make the next tic
+static long long g_lagBudget = 1000000000LL/TICRATE;
+
+// Moving average of the D_Display time, 1/8 of each new frame
+static long long g_drawNanos;
+static long long g_drawStart;
+static long long g_nextDraw;
+static int g_skipped;
+
+// Reported at exit
+static int g_framesRun;
+static int g_framesDrawn;
+static int g_framesLate;
 
 
 int	mb_used = 6;
@@ -107,22 +117,244 @@ byte* I_ZoneBase (int*	size)
 
 
 
+//
+// I_GetNanos
+// Nanoseconds since the first call, on the monotonic clock,
+// which NTP does not step
+//
+static long long I_GetNanos (void)
+{
+    static struct timespec	base;
+    struct timespec		now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (!base.tv_sec && !base.tv_nsec)
+	base = now;
+
+    return (now.tv_sec - base.tv_sec)*1000000000LL + now.tv_nsec - base.tv_nsec;
+}
+
+
 //
 // I_GetTime
-// returns time in 1/70th second tics
+// returns time in 1/35th second tics
 //
 int  I_GetTime (void)
 {
-    struct timeval	tp;
-    // LLatta: Removed struct timezone	tzp;
-    int			newtics;
-    static int		basetime=0;
-  
-    gettimeofday(&tp, 0);
-    if (!basetime)
-	basetime = tp.tv_sec;
-    newtics = (tp.tv_sec-basetime)*TICRATE + tp.tv_usec*TICRATE/1000000;
-    return newtics;
+    return I_GetNanos()*TICRATE/1000000000LL;
+}
+
+
+//
+// I_GetTicFrac
+// How far the time is into the current tic
+//
+fixed_t I_GetTicFrac (void)
+{
+    return (I_GetNanos()*TICRATE%1000000000LL)*FRACUNIT/1000000000LL;
+}
+
+
+
+//
+// I_NanosToTic
+// Time left until I_GetTime advances
+//
+static long long I_NanosToTic (long long now)
+{
+    long long		next;
+
+    // first nanosecond of the next tic, as I_GetTime rounds
+    next = now*TICRATE/1000000000LL + 1;
+    next = (next*1000000000LL + TICRATE - 1)/TICRATE;
+
+    return next - now;
+}
+
+
+//
+// I_WaitTic
+// Sleep until I_GetTime advances, instead of spinning on it
+//
+void I_WaitTic (void)
+{
+    struct timespec	ts;
+    long long		left;
+
+    left = I_NanosToTic (I_GetNanos());
+
+    ts.tv_sec = left/1000000000LL;
+    ts.tv_nsec = left%1000000000LL;
+    nanosleep(&ts, NULL);
+}
+
+
+//
+// I_InitFramePacing
+//
+static void I_InitFramePacing (void)
+{
+    int		p;
+
+    g_interpolate = M_CheckParm ("-interpolate") != 0;
+    if (g_interpolate)
+	g_targetFps = 2*TICRATE;
+
+    p = M_CheckParm ("-fps");
+    if (p && p < myargc-1)
+    {
+	g_targetFps = atoi (myargv[p+1]);
+	if (g_targetFps < 1)
+	    I_Error ("Bad -fps %s", myargv[p+1]);
+    }
+
+    g_frameSkip = M_CheckParm ("-frameskip") != 0;
+
+    p = M_CheckParm ("-maxskip");
+    if (p && p < myargc-1)
+    {
+	g_maxSkip = atoi (myargv[p+1]);
+	if (g_maxSkip < 0)
+	    I_Error ("Bad -maxskip %s", myargv[p+1]);
+    }
+
+    p = M_CheckParm ("-lagbudget");
+    if (p && p < myargc-1)
+    {
+	g_lagBudget = atoi (myargv[p+1])*1000000LL;
+	if (g_lagBudget < 0)
+	    I_Error ("Bad -lagbudget %s", myargv[p+1]);
+    }
+
+    if (g_interpolate)
+	printf ("I_Init: interpolating, pacing frames at %i fps\n", g_targetFps);
+    else if (g_frameSkip)
+	printf ("I_Init: drawing at most %i fps\n", g_targetFps);
+    else if (g_targetFps < TICRATE)
+	printf ("I_Init: pacing frames at %i fps\n", g_targetFps);
+
+    if (g_frameSkip)
+	printf ("I_Init: skipping up to %i frames in a row, %lli ms lag budget\n",
+		g_maxSkip, g_lagBudget/1000000);
+
+    g_frameNanos = 1000000000L/g_targetFps;
+    clock_gettime(CLOCK_MONOTONIC, &g_frameDeadline);
+}
+
+
+//
+// I_WaitFrame
+// Called by D_DoomLoop before starting a frame. Sleeps until the
+// frame is due, against absolute deadlines so frame times do not
+// drift with the time spent drawing.
+//
+void I_WaitFrame (void)
+{
+    struct timespec	now;
+    long long		late;
+
+    if ((g_targetFps >= TICRATE || g_frameSkip) && !g_interpolate)
+	return;
+
+    g_frameDeadline.tv_nsec += g_frameNanos;
+    if (g_frameDeadline.tv_nsec >= 1000000000L)
+    {
+	g_frameDeadline.tv_sec++;
+	g_frameDeadline.tv_nsec -= 1000000000L;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    late = (long long)(now.tv_sec - g_frameDeadline.tv_sec)*1000000000LL
+	+ now.tv_nsec - g_frameDeadline.tv_nsec;
+
+    // More than a frame behind, start again from now rather than
+    // rushing out frames to catch up
+    if (late > g_frameNanos)
+    {
+	g_frameDeadline = now;
+	return;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &g_frameDeadline, NULL))
+	;
+}
+
+
+//
+// I_SkipFrame
+// Called by D_DoomLoop after running the tics, with backlog the
+// tics built but not run yet. Under -frameskip, returns true to
+// leave D_Display out: when no frame is due under -fps, or when
+// the average draw would end later than the lag budget past the
+// next tic, up to -maxskip times in a row.
+//
+boolean I_SkipFrame (int backlog)
+{
+    long long	now;
+    long long	left;
+
+    if (!g_frameSkip)
+	return false;
+
+    now = I_GetNanos();
+    g_framesRun++;
+
+    // Decimate to -fps, half a tic early is on time as the loop
+    // wakes on tics. More than a frame behind, start again.
+    if (now < g_nextDraw - 500000000LL/TICRATE)
+	return true;
+    g_nextDraw += g_frameNanos;
+    if (g_nextDraw < now)
+	g_nextDraw = now + g_frameNanos;
+
+    left = I_NanosToTic (now) - backlog*(1000000000LL/TICRATE);
+    if (g_skipped < g_maxSkip && g_drawNanos > left + g_lagBudget)
+    {
+	g_skipped++;
+	g_framesLate++;
+	return true;
+    }
+
+    g_skipped = 0;
+    g_drawStart = now;
+    return false;
+}
+
+
+//
+// I_FrameDrawn
+// After D_Display, counts its time into the average unless
+// measure is false, as for wipes that loop on their own.
+//
+void I_FrameDrawn (boolean measure)
+{
+    long long	nanos;
+
+    if (!g_frameSkip)
+	return;
+
+    g_framesDrawn++;
+    if (!measure)
+	return;
+
+    nanos = I_GetNanos() - g_drawStart;
+    if (!g_drawNanos)
+	g_drawNanos = nanos;
+    else
+	g_drawNanos += (nanos - g_drawNanos)/8;
+}
+
+
+//
+// I_ShutdownFramePacing
+//
+static void I_ShutdownFramePacing (void)
+{
+    if (!g_frameSkip || !g_framesRun)
+	return;
+
+    printf ("I_Quit: drew %i of %i frames, %i left out under load, %.1f ms a frame\n",
+	    g_framesDrawn, g_framesRun, g_framesLate, g_drawNanos/1000000.0);
 }
 
 
@@ -132,13 +364,12 @@ int  I_GetTime (void)
 //
 void I_Init (void)
 {
+    I_InitFramePacing();
+    I_InitProfile();
     I_InitSound();
+    I_InitMusic();
+    I_InitInput();
     //  I_InitGraphics();
-
-	if ((g_gamepad = open(g_gamepadName, O_RDONLY | O_NONBLOCK)) < 0)
-	{
-		fprintf(stderr, "Cannot access gamepad at %s. Will retry.\n", g_gamepadName);
-	}
 }
 
 //
@@ -151,12 +382,9 @@ void I_Quit (void)
     I_ShutdownMusic();
     M_SaveDefaults ();
     I_ShutdownGraphics();
-
-
-	if (g_gamepad >= 0)
-	{
-		close(g_gamepad);
-	}
+    I_ShutdownInput();
+    I_ShutdownProfile();
+    I_ShutdownFramePacing();
 
     exit(0);
 }
@@ -221,68 +449,10 @@ void I_Error (char *error, ...)
 }
 
 
-event_t joystickEvent = { ev_joystick };
-
 void I_GetEvent(void)
 {
-	if (g_gamepad < 0)
-	{
-		if ((g_gamepad = open(g_gamepadName, O_RDONLY | O_NONBLOCK)) < 0)
-		{
-			return;
-		}
-	}
-
-	while (1)
-	{
-		struct input_event ev[64];
-
-		int rd = read(g_gamepad, ev, sizeof(ev));
-
-		if (rd < (int) sizeof(struct input_event))
-		{
-			break;
-		}
-
-		int i;
-		for (i = 0; i < rd / (int)sizeof(struct input_event); i++)
-		{
-			//printf("Event: time %ld.%06ld, type %d, code %d,", ev[i].time.tv_sec, ev[i].time.tv_usec, ev[i].type, ev[i].code);
-
-			struct input_event e = ev[i];
-
-			switch (e.type)
-			{
-			case EV_ABS:
-				if (e.code == ABS_X)
-					joystickEvent.data2 = e.value < 100 ? -1 : e.value < 150 ? 0 : 1;
-				else if (e.code == ABS_Y)
-					joystickEvent.data3 = e.value < 100 ? -1 : e.value < 150 ? 0 : 1;
-
-				break;
-			case EV_KEY:
-				switch (e.code)
-				{
-				case BTN_B:
-					joystickEvent.data1 = (joystickEvent.data1 & ~1) | e.value;
-					break;
-				case BTN_C:
-					joystickEvent.data1 = (joystickEvent.data1 & ~2) | (e.value << 1);
-					break;
-				case BTN_A:
-					joystickEvent.data1 = (joystickEvent.data1 & ~4) | (e.value << 2);
-					break;
-				case BTN_X:
-					joystickEvent.data1 = (joystickEvent.data1 & ~8) | (e.value << 3);
-					break;
-				}
-
-				break;
-			}
-
-			D_PostEvent(&joystickEvent);
-		}
-	}
+	// The input thread gathers the gamepad state
+	I_PostInput();
 //
 //    event_t event;
 //
@@ -444,7 +614,6 @@ void I_GetEvent(void)
 //
 void I_StartFrame (void)
 {
-	I_GetEvent();
 }
 
 //
@@ -452,4 +621,5 @@ void I_StartFrame (void)
 //
 void I_StartTic (void)
 {
+	I_GetEvent();
 }
@@ -25,6 +25,7 @@
 
 #include "d_ticcmd.h"
 #include "d_event.h"
+#include "m_fixed.h"
 
 #ifdef __GNUG__
 #pragma interface
@@ -44,6 +45,27 @@ byte*	I_ZoneBase (int *size);
 // returns current time in tics.
 int I_GetTime (void);
 
+// How far into the current tic, 0 to FRACUNIT.
+fixed_t I_GetTicFrac (void);
+
+// -interpolate, frames are drawn between tics.
+extern boolean g_interpolate;
+
+
+// Sleeps until I_GetTime will return the next tic.
+void I_WaitTic (void);
+
+// Called by D_DoomLoop before each frame,
+// sleeps until it is due under -fps.
+void I_WaitFrame (void);
+
+// Called by D_DoomLoop after the tics, true to leave
+// D_Display out under -frameskip. backlog is the
+// tics built and not run yet.
+boolean I_SkipFrame (int backlog);
+
+// Called after D_Display, measure false for wipes.
+void I_FrameDrawn (boolean measure);
 
 //
 // Called by D_DoomLoop,
@@ -0,0 +1,747 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	ILI9341 TFT display controller commands, and the 8-bit parallel
+//	bus to it on the Edison Arduino GPIO pins, driven through
+//	memory mapped registers.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef NOMRAA
+#include <mraa/gpio.h>
+#endif
+
+#include "doomstat.h"
+#include "i_system.h"
+#include "i_tft.h"
+#include "i_viddev.h"
+#include "m_argv.h"
+#include "v_video.h"
+
+#include "doomdef.h"
+
+
+tftbus_t* g_tftbus = NULL;
+
+// How the 320x200 frame is placed on the 320x240 panel, -tftmode <name>
+typedef enum
+{
+	tft_letterbox, // 1:1, centred, black bars above and below
+	tft_stretch, // Rows repeated to fill all 240 panel rows
+	tft_half, // Every other pixel and row, 160x100 centred
+	NUMTFTMODES
+} tftmode_t;
+
+static char* g_modeNames[NUMTFTMODES] = { "letterbox", "stretch", "half" };
+
+static tftmode_t g_mode = tft_letterbox;
+
+// Panel position of the top left frame pixel
+static int g_originX;
+static int g_originY;
+
+// tft_stretch: frame row shown on each panel row, and the range of
+// panel rows showing each frame row
+static int g_rowSource[TFTWIDTH];
+static int g_rowFirst[SCREENHEIGHT];
+static int g_rowLast[SCREENHEIGHT];
+
+// Address window last programmed, only MEMORYWRITE is needed to reuse it
+static int g_windowX1, g_windowY1, g_windowX2, g_windowY2;
+
+// Helper macros to switch bus lines
+#define CD_COMMAND g_tftbus->SetCD(0)
+#define CD_DATA    g_tftbus->SetCD(1)
+#define CS_ACTIVE  g_tftbus->SetCS(0)
+#define CS_IDLE    g_tftbus->SetCS(1)
+#define WR_STROBE  g_tftbus->Strobe();
+
+static void TFT_Write8(uint8_t value)
+{
+	g_tftbus->Write8(value);
+}
+
+static void TFT_Write16(uint16_t value)
+{
+	g_tftbus->Write16(value);
+}
+
+static void TFT_MilliSleep(int milliseconds)
+{
+	g_tftbus->Delay(milliseconds);
+}
+
+void TFT_WriteRegister8(uint8_t a, uint8_t d)
+{
+	CD_COMMAND;
+	TFT_Write8(a);
+	CD_DATA;
+	TFT_Write8(d);
+}
+
+void TFT_WriteRegister16(uint8_t a, uint16_t d)
+{
+	CD_COMMAND;
+	TFT_Write8(a);
+	CD_DATA;
+	TFT_Write16(d);
+}
+
+void TFT_WriteRegister32(uint8_t r, uint32_t d)
+{
+	CD_COMMAND;
+	TFT_Write8(r);
+	CD_DATA;
+	TFT_Write8(d >> 24);
+	TFT_Write8(d >> 16);
+	TFT_Write8(d >> 8);
+	TFT_Write8(d);
+}
+
+// Set the address window for the following pixel data and start writing.
+// Coordinates are inclusive panel pixels, x along the long landscape axis.
+void TFT_SetWindow(int x1, int y1, int x2, int y2)
+{
+	if (x1 != g_windowX1 || x2 != g_windowX2)
+	{
+		TFT_WriteRegister32(ILI9341_COLADDRSET, (uint32_t) x1 << 16 | x2);
+		g_windowX1 = x1;
+		g_windowX2 = x2;
+	}
+	if (y1 != g_windowY1 || y2 != g_windowY2)
+	{
+		TFT_WriteRegister32(ILI9341_PAGEADDRSET, (uint32_t) y1 << 16 | y2);
+		g_windowY1 = y1;
+		g_windowY2 = y2;
+	}
+	CD_COMMAND;
+	TFT_Write8(ILI9341_MEMORYWRITE);
+	CD_DATA;
+}
+
+// Panel window covering a rectangle of the frame
+static void TFT_MapRect(const dirtyrect_t* r, dirtyrect_t* w)
+{
+	switch (g_mode)
+	{
+	case tft_stretch:
+		w->x1 = g_originX + r->x1;
+		w->x2 = g_originX + r->x2;
+		w->y1 = g_rowFirst[r->y1];
+		w->y2 = g_rowLast[r->y2];
+		break;
+
+	case tft_half:
+		w->x1 = g_originX + (r->x1 >> 1);
+		w->x2 = g_originX + (r->x2 >> 1);
+		w->y1 = g_originY + (r->y1 >> 1);
+		w->y2 = g_originY + (r->y2 >> 1);
+		break;
+
+	default:
+		w->x1 = g_originX + r->x1;
+		w->x2 = g_originX + r->x2;
+		w->y1 = g_originY + r->y1;
+		w->y2 = g_originY + r->y2;
+		break;
+	}
+}
+
+// Select the output mode and program the window of a full frame
+static void TFT_InitMode(void)
+{
+	static const dirtyrect_t full = { 0, 0, SCREENWIDTH - 1, SCREENHEIGHT - 1 };
+	dirtyrect_t w;
+	int p;
+	int i;
+
+	p = M_CheckParm("-tftmode");
+	if (p && p < myargc - 1)
+	{
+		for (i = 0; i < NUMTFTMODES; i++)
+		{
+			if (!strcasecmp(g_modeNames[i], myargv[p + 1]))
+				break;
+		}
+		if (i == NUMTFTMODES)
+			I_Error("Unknown TFT mode %s", myargv[p + 1]);
+
+		g_mode = i;
+	}
+
+	switch (g_mode)
+	{
+	case tft_stretch:
+		g_originX = (TFTHEIGHT - SCREENWIDTH) / 2;
+		g_originY = 0;
+		for (i = 0; i < TFTWIDTH; i++)
+		{
+			int y = i * SCREENHEIGHT / TFTWIDTH;
+			g_rowSource[i] = y;
+			if (!i || g_rowSource[i - 1] != y)
+				g_rowFirst[y] = i;
+			g_rowLast[y] = i;
+		}
+		break;
+
+	case tft_half:
+		g_originX = (TFTHEIGHT - SCREENWIDTH / 2) / 2;
+		g_originY = (TFTWIDTH - SCREENHEIGHT / 2) / 2;
+		break;
+
+	default:
+		g_originX = (TFTHEIGHT - SCREENWIDTH) / 2;
+		g_originY = (TFTWIDTH - SCREENHEIGHT) / 2;
+		break;
+	}
+
+	TFT_MapRect(&full, &w);
+	TFT_SetWindow(w.x1, w.y1, w.x2, w.y2);
+
+	fprintf(stderr, "TFT %s mode, %dx%d, %d bytes per full frame\n",
+			g_modeNames[g_mode], w.x2 - w.x1 + 1, w.y2 - w.y1 + 1, TFT_FrameBytes());
+}
+
+// Bytes on the bus for the pixels of a full frame in the current mode
+int TFT_FrameBytes(void)
+{
+	switch (g_mode)
+	{
+	case tft_stretch:
+		return SCREENWIDTH * TFTWIDTH * 2;
+	case tft_half:
+		return (SCREENWIDTH / 2) * (SCREENHEIGHT / 2) * 2;
+	default:
+		return SCREENWIDTH * SCREENHEIGHT * 2;
+	}
+}
+
+// Frame pixel shown at a panel position, NULL outside of the frame
+byte* TFT_PanelSource(byte* frame, int x, int y)
+{
+	x -= g_originX;
+	y -= g_originY;
+
+	switch (g_mode)
+	{
+	case tft_stretch:
+		if (x < 0 || x >= SCREENWIDTH)
+			return NULL;
+		return frame + g_rowSource[y] * SCREENWIDTH + x;
+
+	case tft_half:
+		if (x < 0 || x >= SCREENWIDTH / 2 || y < 0 || y >= SCREENHEIGHT / 2)
+			return NULL;
+		return frame + (y * 2) * SCREENWIDTH + x * 2;
+
+	default:
+		if (x < 0 || x >= SCREENWIDTH || y < 0 || y >= SCREENHEIGHT)
+			return NULL;
+		return frame + y * SCREENWIDTH + x;
+	}
+}
+
+void TFT_InitDisplay(void)
+{
+	int i;
+
+	// Nothing programmed yet, the first window must be sent in full
+	g_windowX1 = g_windowY1 = g_windowX2 = g_windowY2 = -1;
+
+	// Data transfer sync
+	CS_ACTIVE;
+	CD_COMMAND;
+	TFT_Write8(0x00);
+	for (i = 0; i < 3; i++)
+	{
+		WR_STROBE // Three extra 0x00s
+	}
+	CS_IDLE;
+
+	TFT_MilliSleep(200);
+
+	CS_ACTIVE;
+	TFT_WriteRegister8(ILI9341_SOFTRESET, 0);
+	TFT_MilliSleep(50);
+	TFT_WriteRegister8(ILI9341_DISPLAYOFF, 0);
+
+	TFT_WriteRegister8(ILI9341_POWERCONTROL1, 0x23);
+	TFT_WriteRegister8(ILI9341_POWERCONTROL2, 0x10);
+	TFT_WriteRegister16(ILI9341_VCOMCONTROL1, 0x2B2B);
+	TFT_WriteRegister8(ILI9341_VCOMCONTROL2, 0xC0);
+	TFT_WriteRegister8(ILI9341_MEMCONTROL, ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR);
+	TFT_WriteRegister8(ILI9341_PIXELFORMAT, 0x55);
+	TFT_WriteRegister16(ILI9341_FRAMECONTROL, 0x001B);
+
+	TFT_WriteRegister8(ILI9341_ENTRYMODE, 0x07);
+	/* TFT_WriteRegister32(ILI9341_DISPLAYFUNC, 0x0A822700);*/
+
+//	TFT_WriteRegister16(0xF2, 0x00);    // 3Gamma Function Disable
+//	TFT_WriteRegister16(ILI9341_GAMMASET, 0x01);    //Gamma curve selected
+	/*
+	 CD_COMMAND;
+	 TFT_Write8(ILI9341_GMCTRP1);    //Set Gamma
+	 CD_DATA;
+	 #ifdef ADAFRUIT_GAMMA
+	 TFT_Write16(0x0F);
+	 TFT_Write16(0x31);
+	 TFT_Write16(0x2B);
+	 TFT_Write16(0x0C);
+	 TFT_Write16(0x0E);
+	 TFT_Write16(0x08);
+	 TFT_Write16(0x4E);
+	 TFT_Write16(0xF1);
+	 TFT_Write16(0x37);
+	 TFT_Write16(0x07);
+	 TFT_Write16(0x10);
+	 TFT_Write16(0x03);
+	 TFT_Write16(0x0E);
+	 TFT_Write16(0x09);
+	 TFT_Write16(0x00);
+	 #else
+	 // From MI0283QT-11 spec
+	 TFT_Write16(0x001f);
+	 TFT_Write16(0x001a);
+	 TFT_Write16(0x0018);
+	 TFT_Write16(0x000a);
+	 TFT_Write16(0x000f);
+	 TFT_Write16(0x0006);
+	 TFT_Write16(0x0045);
+	 TFT_Write16(0x0087);
+	 TFT_Write16(0x0032);
+	 TFT_Write16(0x000a);
+	 TFT_Write16(0x0007);
+	 TFT_Write16(0x0002);
+	 TFT_Write16(0x0007);
+	 TFT_Write16(0x0005);
+	 TFT_Write16(0x0000);
+	 #endif
+
+	 CD_COMMAND;
+	 TFT_Write8(ILI9341_GMCTRN1);    //Set Gamma
+	 CD_DATA;
+	 #ifdef ADAFRUIT_GAMMA
+	 TFT_Write16(0x00);
+	 TFT_Write16(0x0E);
+	 TFT_Write16(0x14);
+	 TFT_Write16(0x03);
+	 TFT_Write16(0x11);
+	 TFT_Write16(0x07);
+	 TFT_Write16(0x31);
+	 TFT_Write16(0xC1);
+	 TFT_Write16(0x48);
+	 TFT_Write16(0x08);
+	 TFT_Write16(0x0F);
+	 TFT_Write16(0x0C);
+	 TFT_Write16(0x31);
+	 TFT_Write16(0x36);
+	 TFT_Write16(0x0F);
+	 #else
+	 // From MI0283QT-11 spec
+	 TFT_Write16(0x0000);
+	 TFT_Write16(0x0025);
+	 TFT_Write16(0x0027);
+	 TFT_Write16(0x0005);
+	 TFT_Write16(0x0010);
+	 TFT_Write16(0x0009);
+	 TFT_Write16(0x003a);
+	 TFT_Write16(0x0078);
+	 TFT_Write16(0x004d);
+	 TFT_Write16(0x0005);
+	 TFT_Write16(0x0018);
+	 TFT_Write16(0x000d);
+	 TFT_Write16(0x0038);
+	 TFT_Write16(0x003a);
+	 TFT_Write16(0x001f);
+	 #endif
+	 */
+	TFT_WriteRegister8(ILI9341_SLEEPOUT, 0);
+	TFT_MilliSleep(150);
+	TFT_WriteRegister8(ILI9341_DISPLAYON, 0);
+	TFT_MilliSleep(500);
+
+	// Set screen to be rotated to landscape mode
+	TFT_WriteRegister8(ILI9341_MADCTL,
+			ILI9341_MADCTL_MX | ILI9341_MADCTL_MY | ILI9341_MADCTL_MV | ILI9341_MADCTL_BGR); // MADCTL
+
+	// Set full screen as write region (width<->height swapped due to landscape)
+	TFT_SetWindow(0, 0, TFTHEIGHT - 1, TFTWIDTH - 1);
+
+	// Clear screen to black
+	for (i = TFTWIDTH * TFTHEIGHT; i; i--)
+	{
+		TFT_Write16(0);
+	}
+
+	// Leave the window of a full frame programmed, so full
+	// frames only need a MEMORYWRITE
+	TFT_InitMode();
+
+	CS_IDLE;
+}
+
+// Pass 8-bit (each) R,G,B, get back 16-bit packed color
+uint16_t I_MakeColor565(uint8_t r, uint8_t g, uint8_t b)
+{
+	return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+void TFT_SetPalette(byte* palette)
+{
+	uint16_t colors[256];
+	int i;
+	for (i = 0; i < 256; i++)
+	{
+		colors[i] = I_MakeColor565(palette[0], palette[1], palette[2]);
+		palette += 3;
+	}
+	g_tftbus->SetPalette(colors);
+}
+
+void TFT_StartUpdate(void)
+{
+	CS_ACTIVE;
+}
+
+// Stream a rectangle of the frame into a matching address window
+void TFT_WriteRect(byte* frame, const dirtyrect_t* r)
+{
+	dirtyrect_t w;
+	int width;
+	int y;
+
+	TFT_MapRect(r, &w);
+	TFT_SetWindow(w.x1, w.y1, w.x2, w.y2);
+
+	width = w.x2 - w.x1 + 1;
+
+	switch (g_mode)
+	{
+	case tft_stretch:
+		for (y = w.y1; y <= w.y2; y++)
+		{
+			g_tftbus->WritePixels(frame + g_rowSource[y] * SCREENWIDTH + r->x1, width);
+		}
+		break;
+
+	case tft_half:
+		for (y = w.y1; y <= w.y2; y++)
+		{
+			byte line[SCREENWIDTH / 2];
+			byte* s = TFT_PanelSource(frame, w.x1, y);
+			int x;
+			for (x = 0; x < width; x++)
+			{
+				line[x] = s[x * 2];
+			}
+			g_tftbus->WritePixels(line, width);
+		}
+		break;
+
+	default:
+		for (y = r->y1; y <= r->y2; y++)
+		{
+			g_tftbus->WritePixels(frame + y * SCREENWIDTH + r->x1, width);
+		}
+		break;
+	}
+}
+
+void TFT_FinishUpdate(byte* frame)
+{
+	CS_IDLE;
+}
+
+
+#ifndef NOMRAA
+
+//
+// The parallel bus on the Edison GPIO pins
+//
+
+// Edison Arduino pin assignments for TFT controller
+static const int TFT_CS = 9;
+static const int TFT_CD = 8;
+static const int TFT_WR = 7;
+static const int TFT_RD = 6;
+static const int TFT_DATA[8] = { 13, 10, 12, 11, 14, 15, 16, 17 };
+
+// First hardware pin number of the data bits, ie 40-47, and WR flag assumed in the same % 32 range
+static const int TFT_EDISON_DATA0 = 40;
+static const int TFT_EDISON_WR = 48;
+
+// GPIO pins to drive display
+static mraa_gpio_context g_csPinCtx = 0;
+static mraa_gpio_context g_cdPinCtx = 0;
+static mraa_gpio_context g_wrPinCtx = 0;
+static mraa_gpio_context g_rdPinCtx = 0;
+static mraa_gpio_context g_dataPinCtx[8] = { 0 };
+
+// This is an absolute path to a resource file found within sysfs.
+// Might not always be correct. First thing to check if mmap stops
+// working. Check the device for 0x1199 and Intel Vendor (0x8086)
+#define MMAP_PATH "/sys/devices/pci0000:00/0000:00:0c.0/resource0"
+
+// Memory mapped registers to set the data pins faster than through MRAA interface
+static uint8_t *g_MmapRegisterSet = NULL;
+static uint8_t *g_MmapRegisterClear = NULL;
+
+// Ready made register words to send each palette color, see GPIO_Write16.
+// Outside of RUN_WITHIN_SPEC the set words include the WR bit.
+typedef struct
+{
+	uint32_t setHi;
+	uint32_t clearHi;
+	uint32_t setLo;
+	uint32_t clearLo;
+} gpiopixel_t;
+
+static gpiopixel_t g_pixelWords[256];
+
+
+// Data write strobe, ~2 instructions and always inline
+#define GPIO_WR_STROBE { uint32_t bit = (uint32_t)((uint32_t)1 << (TFT_EDISON_WR % 32)); \
+	*(volatile uint32_t*)g_MmapRegisterClear = bit; \
+	*(volatile uint32_t*)g_MmapRegisterSet = bit; }
+
+// Initialize a GPIO pin for writing
+mraa_gpio_context GPIO_InitPin(int pin)
+{
+	mraa_gpio_context context = mraa_gpio_init(pin);
+	if (context == NULL)
+	{
+		I_Error("Failed to open video display pin %d", pin);
+	}
+
+	mraa_gpio_dir(context, MRAA_GPIO_OUT);
+	mraa_gpio_use_mmaped(context, 1);
+
+	return context;
+}
+
+// Initialize fast access to GPIO via memory mapping the PCI device
+void GPIO_InitMmap()
+{
+	int mmap_fd;
+	if ((mmap_fd = open(MMAP_PATH, O_RDWR)) < 0)
+	{
+		I_Error("Cannot open GPIO device: %s\n", MMAP_PATH);
+	}
+
+	struct stat fd_stat;
+	fstat(mmap_fd, &fd_stat);
+
+	uint8_t* mmap_reg = (uint8_t*) mmap(NULL, fd_stat.st_size,
+			PROT_READ | PROT_WRITE, MAP_FILE | MAP_SHARED, mmap_fd, 0);
+	if (mmap_reg == MAP_FAILED)
+	{
+		I_Error("Failed to mmap GPIO device\n");
+	}
+
+	uint8_t offset = ((TFT_EDISON_DATA0 / 32) * sizeof(uint32_t));
+	g_MmapRegisterSet = mmap_reg + offset + 0x34;
+	g_MmapRegisterClear = mmap_reg + offset + 0x4c;
+}
+
+
+static void GPIO_Write8(uint8_t value)
+{
+	uint32_t set = (uint32_t) value << (TFT_EDISON_DATA0 % 32);
+	uint32_t clear = ((uint32_t) ((uint8_t) ~value) << (TFT_EDISON_DATA0 % 32))
+			| (uint32_t) 1u << (TFT_EDISON_WR % 32);
+	uint32_t setWr = (uint32_t) 1 << (TFT_EDISON_WR % 32);
+	*(volatile uint32_t*) g_MmapRegisterSet = set;
+	*(volatile uint32_t*) g_MmapRegisterClear = clear;
+	*(volatile uint32_t*) g_MmapRegisterSet = setWr;
+}
+
+static void GPIO_Write16(uint16_t value)
+{
+	uint8_t hi = value >> 8;
+	uint8_t lo = value;
+
+	uint32_t setHi = (uint32_t) hi << (TFT_EDISON_DATA0 % 32);
+	uint32_t clearHi = ((uint32_t) ((uint8_t) ~hi) << (TFT_EDISON_DATA0 % 32))
+			| (uint32_t) 1 << (TFT_EDISON_WR % 32);
+	uint32_t setLo = (uint32_t) lo << (TFT_EDISON_DATA0 % 32);
+	uint32_t clearLo = ((uint32_t) ((uint8_t) ~lo) << (TFT_EDISON_DATA0 % 32))
+			| (uint32_t) 1 << (TFT_EDISON_WR % 32);
+	uint32_t setWr = (uint32_t) 1 << (TFT_EDISON_WR % 32);
+
+#if RUN_WITHIN_SPEC
+	// The display controller spec wants us to hold the data lines at their steady value
+	// on the transition of WR from low to high for at least 10 ns.
+	// This version will do that:
+	*(volatile uint32_t*)g_MmapRegisterSet = setHi;
+	*(volatile uint32_t*)g_MmapRegisterClear = clearHi;
+	*(volatile uint32_t*)g_MmapRegisterSet = setWr;
+	*(volatile uint32_t*)g_MmapRegisterSet = setLo;
+	*(volatile uint32_t*)g_MmapRegisterClear = clearLo;
+	*(volatile uint32_t*)g_MmapRegisterSet = setWr;
+#else
+	// Disregarding the spec, it seems to "currently" work to merge the WR switch with
+	// the subsequent data write, shaving off two of six write cycles.
+	// If this stops working in the future, it might be fixable by delaying the WR signal
+	// a little, maybe with a capacitor/low pass filterish circuit.
+	*(volatile uint32_t*) g_MmapRegisterSet = setWr | setHi;
+	*(volatile uint32_t*) g_MmapRegisterClear = clearHi;
+	*(volatile uint32_t*) g_MmapRegisterSet = setWr | setLo;
+	*(volatile uint32_t*) g_MmapRegisterClear = clearLo;
+#endif
+}
+
+static void GPIO_SetCS(int level)
+{
+	mraa_gpio_write(g_csPinCtx, level);
+}
+
+static void GPIO_SetCD(int level)
+{
+	mraa_gpio_write(g_cdPinCtx, level);
+}
+
+static void GPIO_SetPalette(uint16_t* palette)
+{
+	uint32_t setWr = (uint32_t) 1 << (TFT_EDISON_WR % 32);
+	int i;
+
+	for (i = 0; i < 256; i++)
+	{
+		uint8_t hi = palette[i] >> 8;
+		uint8_t lo = palette[i];
+		gpiopixel_t* w = &g_pixelWords[i];
+
+		w->setHi = (uint32_t) hi << (TFT_EDISON_DATA0 % 32);
+		w->clearHi = ((uint32_t) ((uint8_t) ~hi) << (TFT_EDISON_DATA0 % 32)) | setWr;
+		w->setLo = (uint32_t) lo << (TFT_EDISON_DATA0 % 32);
+		w->clearLo = ((uint32_t) ((uint8_t) ~lo) << (TFT_EDISON_DATA0 % 32)) | setWr;
+#if !RUN_WITHIN_SPEC
+		w->setHi |= setWr;
+		w->setLo |= setWr;
+#endif
+	}
+}
+
+// Same register writes as GPIO_Write16, just table lookups per pixel
+static void GPIO_WritePixels(byte* src, int count)
+{
+	volatile uint32_t* set = (volatile uint32_t*) g_MmapRegisterSet;
+	volatile uint32_t* clear = (volatile uint32_t*) g_MmapRegisterClear;
+#if RUN_WITHIN_SPEC
+	uint32_t setWr = (uint32_t) 1 << (TFT_EDISON_WR % 32);
+#endif
+
+	for (; count; count--)
+	{
+		const gpiopixel_t* w = &g_pixelWords[*src++];
+#if RUN_WITHIN_SPEC
+		*set = w->setHi;
+		*clear = w->clearHi;
+		*set = setWr;
+		*set = w->setLo;
+		*clear = w->clearLo;
+		*set = setWr;
+#else
+		*set = w->setHi;
+		*clear = w->clearHi;
+		*set = w->setLo;
+		*clear = w->clearLo;
+#endif
+	}
+}
+
+static void GPIO_Strobe(void)
+{
+	GPIO_WR_STROBE
+}
+
+static void GPIO_Delay(int milliseconds)
+{
+	usleep(milliseconds * 1000);
+}
+
+static tftbus_t g_gpiobus =
+{
+	GPIO_SetCS,
+	GPIO_SetCD,
+	GPIO_Write8,
+	GPIO_Write16,
+	GPIO_SetPalette,
+	GPIO_WritePixels,
+	GPIO_Strobe,
+	GPIO_Delay
+};
+
+void TFT_Init(void)
+{
+	// Initialize GPIO pins
+	g_csPinCtx = GPIO_InitPin(TFT_CS);
+	g_cdPinCtx = GPIO_InitPin(TFT_CD);
+	g_wrPinCtx = GPIO_InitPin(TFT_WR);
+	g_rdPinCtx = GPIO_InitPin(TFT_RD);
+	int i;
+	for (i = 0; i < 8; ++i)
+	{
+		g_dataPinCtx[i] = GPIO_InitPin(TFT_DATA[i]);
+	}
+
+	GPIO_InitMmap();
+
+	// Idle write and read strobes
+	mraa_gpio_write(g_wrPinCtx, 1);
+	mraa_gpio_write(g_rdPinCtx, 1);
+
+	g_tftbus = &g_gpiobus;
+	TFT_InitDisplay();
+}
+
+void TFT_Shutdown(void)
+{
+	mraa_gpio_close(g_csPinCtx);
+	mraa_gpio_close(g_cdPinCtx);
+	mraa_gpio_close(g_wrPinCtx);
+	mraa_gpio_close(g_rdPinCtx);
+	int i;
+	for (i = 0; i < 8; ++i)
+	{
+		mraa_gpio_close(g_dataPinCtx[i]);
+	}
+}
+
+videodev_t tftvideodev =
+{
+	"tft",
+	TFT_Init,
+	TFT_Shutdown,
+	TFT_SetPalette,
+	TFT_StartUpdate,
+	TFT_WriteRect,
+	TFT_FinishUpdate
+};
+
+#endif // NOMRAA
@@ -0,0 +1,130 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	ILI9341 TFT display controller, shared by the real
+//	display on the GPIO bus and the simulated one.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __I_TFT__
+#define __I_TFT__
+
+#include <stdint.h>
+
+#include "doomtype.h"
+#include "v_video.h"
+
+
+// Size of the TFT display, note it's different from SCREENWIDTH/SCREENHEIGHT.
+// The display is used in landscape, so x runs along TFTHEIGHT.
+#define TFTWIDTH   240
+#define TFTHEIGHT  320
+
+// Command codes for TFT display controller
+#define ILI9341_SOFTRESET          0x01
+#define ILI9341_SLEEPIN            0x10
+#define ILI9341_SLEEPOUT           0x11
+#define ILI9341_NORMALDISP         0x13
+#define ILI9341_INVERTOFF          0x20
+#define ILI9341_INVERTON           0x21
+#define ILI9341_GAMMASET           0x26
+#define ILI9341_DISPLAYOFF         0x28
+#define ILI9341_DISPLAYON          0x29
+#define ILI9341_COLADDRSET         0x2A
+#define ILI9341_PAGEADDRSET        0x2B
+#define ILI9341_MEMORYWRITE        0x2C
+#define ILI9341_PIXELFORMAT        0x3A
+#define ILI9341_FRAMECONTROL       0xB1
+#define ILI9341_DISPLAYFUNC        0xB6
+#define ILI9341_ENTRYMODE          0xB7
+#define ILI9341_POWERCONTROL1      0xC0
+#define ILI9341_POWERCONTROL2      0xC1
+#define ILI9341_VCOMCONTROL1       0xC5
+#define ILI9341_VCOMCONTROL2       0xC7
+#define ILI9341_GMCTRP1            0xE0
+#define ILI9341_GMCTRN1            0xE1
+#define ILI9341_MEMCONTROL         0x36
+#define ILI9341_MADCTL             0x36
+
+#define ILI9341_MADCTL_MY  0x80
+#define ILI9341_MADCTL_MX  0x40
+#define ILI9341_MADCTL_MV  0x20
+#define ILI9341_MADCTL_ML  0x10
+#define ILI9341_MADCTL_RGB 0x00
+#define ILI9341_MADCTL_BGR 0x08
+#define ILI9341_MADCTL_MH  0x04
+
+
+//
+// Signals of the 8-bit parallel bus to the display controller.
+// The command layer in i_tft.c emits its byte stream through this.
+//
+typedef struct
+{
+    // Chip select and command/data lines, level 0 is active/command.
+    void	(*SetCS) (int level);
+    void	(*SetCD) (int level);
+
+    // One byte on the data lines, latched with a WR strobe.
+    void	(*Write8) (uint8_t value);
+
+    // High byte, then low byte.
+    void	(*Write16) (uint16_t value);
+
+    // 16-bit 565 colors for the 8-bit color indices of WritePixels.
+    void	(*SetPalette) (uint16_t* palette);
+
+    // count 8-bit color indices from src, sent as 16-bit colors.
+    void	(*WritePixels) (byte* src, int count);
+
+    // WR strobe with the data lines left as they are.
+    void	(*Strobe) (void);
+
+    void	(*Delay) (int milliseconds);
+
+} tftbus_t;
+
+
+// The bus the command layer currently talks to.
+extern tftbus_t*	g_tftbus;
+
+// Resets and configures the display on g_tftbus, clears it to black.
+void TFT_InitDisplay (void);
+
+// Bytes on the bus for the pixels of a full frame, depends on -tftmode.
+int TFT_FrameBytes (void);
+
+// Frame pixel shown at a panel position, NULL for the black border.
+byte* TFT_PanelSource (byte* frame, int x, int y);
+
+// Pass 8-bit (each) R,G,B, get back 16-bit packed color
+uint16_t I_MakeColor565 (uint8_t r, uint8_t g, uint8_t b);
+
+// Video device functions, see i_viddev.h.
+void TFT_SetPalette (byte* palette);
+void TFT_StartUpdate (void);
+void TFT_WriteRect (byte* frame, const dirtyrect_t* r);
+void TFT_FinishUpdate (byte* frame);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
@@ -0,0 +1,410 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Simulated ILI9341 on a simulated parallel bus. Decodes the
+//	byte stream of the TFT command layer into an in-memory panel
+//	and counts what each frame would cost on the Edison GPIO bus.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomdef.h"
+#include "i_system.h"
+#include "i_tft.h"
+#include "i_viddev.h"
+#include "m_argv.h"
+#include "v_video.h"
+
+
+// Memory mapped register stores per byte and per pixel on the GPIO bus,
+// see GPIO_Write8 and GPIO_Write16
+#define STORES_WRITE8   3
+#define STORES_STROBE   2
+#if RUN_WITHIN_SPEC
+#define STORES_WRITE16  6
+#else
+#define STORES_WRITE16  4
+#endif
+
+// Estimated cost of one register store and one MRAA pin write on the
+// Edison, override with -tftstorens and -tftpinns to match measurements
+#define DEFAULT_STORE_NS  40
+#define DEFAULT_PIN_NS    250
+
+// Bus traffic counters
+typedef struct
+{
+	int strobes; // WR strobes, ie bytes latched by the controller
+	int stores; // Memory mapped register writes
+	int pins; // CS/CD changes through MRAA
+	int windows; // MEMORYWRITE commands
+	int pixels;
+
+} tftsimcost_t;
+
+// Panel memory in the address space set up by MADCTL, so 320 pixels
+// wide in landscape. MX/MY only mirror the physical scan, not the image.
+static uint16_t g_panel[TFTWIDTH * TFTHEIGHT];
+
+// Controller state
+static int g_cs = 1;
+static int g_cd = 1;
+static uint8_t g_lastByte;
+static uint8_t g_command;
+static uint8_t g_params[4];
+static int g_numParams;
+static uint8_t g_madctl;
+static int g_colStart, g_colEnd;
+static int g_pageStart, g_pageEnd;
+static int g_x, g_y;
+static int g_pixelHi = -1;
+
+static tftsimcost_t g_cost;
+static tftsimcost_t g_frameCost;
+static tftsimcost_t g_totalCost;
+static double g_maxFrameNs;
+static int g_frames;
+
+static int g_storeNs = DEFAULT_STORE_NS;
+static int g_pinNs = DEFAULT_PIN_NS;
+
+// -tftsimcheck compares the panel against every frame handed over.
+// With -nodisplaythread screens[0] is still the same at that point,
+// so it is checked too, which catches drawing without V_MarkRect.
+static boolean g_check = false;
+static boolean g_checkScreen = false;
+static int g_badFrames;
+static int g_badScreens;
+static uint16_t g_palette[256];
+
+// -tftsimlog prints the cost of every frame
+static boolean g_log = false;
+
+
+static int SIM_PanelWidth(void)
+{
+	return (g_madctl & ILI9341_MADCTL_MV) ? TFTHEIGHT : TFTWIDTH;
+}
+
+static int SIM_PanelHeight(void)
+{
+	return (g_madctl & ILI9341_MADCTL_MV) ? TFTWIDTH : TFTHEIGHT;
+}
+
+// Memory write with the auto incrementing address counter
+static void SIM_Pixel(uint16_t color)
+{
+	if (g_x < SIM_PanelWidth() && g_y < SIM_PanelHeight())
+	{
+		g_panel[g_y * SIM_PanelWidth() + g_x] = color;
+	}
+	g_cost.pixels++;
+
+	if (++g_x > g_colEnd)
+	{
+		g_x = g_colStart;
+		if (++g_y > g_pageEnd)
+		{
+			g_y = g_pageStart;
+		}
+	}
+}
+
+// A byte latched by the controller
+static void SIM_Byte(uint8_t value)
+{
+	g_lastByte = value;
+	g_cost.strobes++;
+
+	if (g_cs)
+		return;
+
+	if (!g_cd)
+	{
+		g_command = value;
+		g_numParams = 0;
+		if (g_command == ILI9341_MEMORYWRITE)
+		{
+			g_x = g_colStart;
+			g_y = g_pageStart;
+			g_pixelHi = -1;
+			g_cost.windows++;
+		}
+		return;
+	}
+
+	switch (g_command)
+	{
+	case ILI9341_COLADDRSET:
+	case ILI9341_PAGEADDRSET:
+		if (g_numParams < 4)
+		{
+			g_params[g_numParams++] = value;
+		}
+		if (g_numParams == 4)
+		{
+			int start = g_params[0] << 8 | g_params[1];
+			int end = g_params[2] << 8 | g_params[3];
+			if (g_command == ILI9341_COLADDRSET)
+			{
+				g_colStart = start;
+				g_colEnd = end;
+			}
+			else
+			{
+				g_pageStart = start;
+				g_pageEnd = end;
+			}
+		}
+		break;
+
+	case ILI9341_MADCTL:
+		g_madctl = value;
+		break;
+
+	case ILI9341_MEMORYWRITE:
+		if (g_pixelHi < 0)
+		{
+			g_pixelHi = value;
+		}
+		else
+		{
+			SIM_Pixel(g_pixelHi << 8 | value);
+			g_pixelHi = -1;
+		}
+		break;
+
+	default:
+		// Power, gamma and timing setup has no effect on the image
+		break;
+	}
+}
+
+static void SIM_SetCS(int level)
+{
+	g_cs = level;
+	g_cost.pins++;
+}
+
+static void SIM_SetCD(int level)
+{
+	g_cd = level;
+	g_cost.pins++;
+}
+
+static void SIM_Write8(uint8_t value)
+{
+	g_cost.stores += STORES_WRITE8;
+	SIM_Byte(value);
+}
+
+static void SIM_Write16(uint16_t value)
+{
+	g_cost.stores += STORES_WRITE16;
+	SIM_Byte(value >> 8);
+	SIM_Byte(value);
+}
+
+static uint16_t g_busPalette[256];
+
+static void SIM_SetPalette(uint16_t* palette)
+{
+	memcpy(g_busPalette, palette, sizeof(g_busPalette));
+}
+
+static void SIM_WritePixels(byte* src, int count)
+{
+	for (; count; count--)
+	{
+		SIM_Write16(g_busPalette[*src++]);
+	}
+}
+
+static void SIM_Strobe(void)
+{
+	g_cost.stores += STORES_STROBE;
+	SIM_Byte(g_lastByte);
+}
+
+static void SIM_Delay(int milliseconds)
+{
+	// No need to wait for simulated hardware
+}
+
+static tftbus_t g_simbus =
+{
+	SIM_SetCS,
+	SIM_SetCD,
+	SIM_Write8,
+	SIM_Write16,
+	SIM_SetPalette,
+	SIM_WritePixels,
+	SIM_Strobe,
+	SIM_Delay
+};
+
+static double SIM_CostNs(const tftsimcost_t* c)
+{
+	return (double) c->stores * g_storeNs + (double) c->pins * g_pinNs;
+}
+
+static void SIM_AddCost(tftsimcost_t* dest, const tftsimcost_t* c)
+{
+	dest->strobes += c->strobes;
+	dest->stores += c->stores;
+	dest->pins += c->pins;
+	dest->windows += c->windows;
+	dest->pixels += c->pixels;
+}
+
+void SIM_Init(void)
+{
+	int p;
+
+	p = M_CheckParm("-tftstorens");
+	if (p && p < myargc - 1)
+		g_storeNs = atoi(myargv[p + 1]);
+
+	p = M_CheckParm("-tftpinns");
+	if (p && p < myargc - 1)
+		g_pinNs = atoi(myargv[p + 1]);
+
+	g_check = M_CheckParm("-tftsimcheck");
+	g_checkScreen = g_check && M_CheckParm("-nodisplaythread");
+	g_log = M_CheckParm("-tftsimlog");
+
+	g_tftbus = &g_simbus;
+	TFT_InitDisplay();
+
+	fprintf(stderr, "tftsim: init took %d strobes, %.2f ms on the bus\n",
+			g_cost.strobes, SIM_CostNs(&g_cost) / 1.0e6);
+	memset(&g_cost, 0, sizeof(g_cost));
+}
+
+void SIM_Shutdown(void)
+{
+	int n = g_frames ? g_frames : 1;
+
+	fprintf(stderr, "tftsim: %d frames, per frame %d pixels, %d windows, %d strobes,"
+			" %d register stores, %d pin writes\n",
+			g_frames, g_totalCost.pixels / n, g_totalCost.windows / n,
+			g_totalCost.strobes / n, g_totalCost.stores / n, g_totalCost.pins / n);
+	fprintf(stderr, "tftsim: estimated bus time per frame %.2f ms avg, %.2f ms max\n",
+			SIM_CostNs(&g_totalCost) / n / 1.0e6, g_maxFrameNs / 1.0e6);
+	if (g_check)
+	{
+		fprintf(stderr, "tftsim: %d of %d frames sent wrong\n", g_badFrames, g_frames);
+	}
+	if (g_checkScreen)
+	{
+		fprintf(stderr, "tftsim: %d of %d frames differ from screens[0]\n", g_badScreens, g_frames);
+	}
+}
+
+void SIM_SetDevicePalette(byte* palette)
+{
+	int i;
+	for (i = 0; i < 256; i++)
+	{
+		g_palette[i] = I_MakeColor565(palette[i * 3], palette[i * 3 + 1], palette[i * 3 + 2]);
+	}
+
+	TFT_SetPalette(palette);
+}
+
+// Count the pixels where the panel does not show the frame
+static int SIM_CheckFrame(byte* frame)
+{
+	int width = SIM_PanelWidth();
+	int height = SIM_PanelHeight();
+	int bad = 0;
+	int x, y;
+
+	for (y = 0; y < height; y++)
+	{
+		for (x = 0; x < width; x++)
+		{
+			byte* s = TFT_PanelSource(frame, x, y);
+			if (g_panel[y * width + x] != (s ? g_palette[*s] : 0))
+				bad++;
+		}
+	}
+
+	return bad;
+}
+
+void SIM_FinishUpdate(byte* frame)
+{
+	double ns;
+
+	TFT_FinishUpdate(frame);
+
+	g_frameCost = g_cost;
+	memset(&g_cost, 0, sizeof(g_cost));
+	SIM_AddCost(&g_totalCost, &g_frameCost);
+
+	ns = SIM_CostNs(&g_frameCost);
+	if (ns > g_maxFrameNs)
+		g_maxFrameNs = ns;
+
+	if (g_log)
+	{
+		fprintf(stderr, "tftsim: frame %d, %d pixels, %d windows, %d strobes, %.2f ms\n",
+				g_frames, g_frameCost.pixels, g_frameCost.windows,
+				g_frameCost.strobes, ns / 1.0e6);
+	}
+
+	if (g_check)
+	{
+		int bad = SIM_CheckFrame(frame);
+		if (bad)
+		{
+			if (!g_badFrames)
+				fprintf(stderr, "tftsim: frame %d has %d wrong pixels\n", g_frames, bad);
+			g_badFrames++;
+		}
+	}
+
+	if (g_checkScreen)
+	{
+		int bad = SIM_CheckFrame(screens[0]);
+		if (bad)
+		{
+			if (!g_badScreens)
+				fprintf(stderr, "tftsim: frame %d has %d pixels not marked dirty\n", g_frames, bad);
+			g_badScreens++;
+		}
+	}
+
+	g_frames++;
+}
+
+videodev_t tftsimvideodev =
+{
+	"tftsim",
+	SIM_Init,
+	SIM_Shutdown,
+	SIM_SetDevicePalette,
+	TFT_StartUpdate,
+	TFT_WriteRect,
+	SIM_FinishUpdate
+};
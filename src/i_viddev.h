@@ -0,0 +1,81 @@
+// Emacs style mode select   -*- C++ -*- 
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Video output devices behind i_video.c.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __I_VIDDEV__
+#define __I_VIDDEV__
+
+
+#include "doomtype.h"
+#include "v_video.h"
+
+
+//
+// A video output device. i_video.c finds out which parts of
+// a frame changed and hands them over rectangle by rectangle,
+// possibly from the display thread.
+//
+typedef struct
+{
+    // Selected with -video <name>.
+    char*	name;
+
+    // Sets up the device and clears it to black.
+    void	(*Init) (void);
+    void	(*Shutdown) (void);
+
+    // Gamma corrected 8-bit R,G,B for each of the 256 colors,
+    //  applies to all following frames.
+    void	(*SetPalette) (byte* palette);
+
+    // Frame updates: StartUpdate, any number of WriteRect,
+    //  then FinishUpdate with the complete new frame.
+    // Frames are SCREENWIDTH*SCREENHEIGHT color indices,
+    //  rectangles are in inclusive pixel coordinates.
+    void	(*StartUpdate) (void);
+    void	(*WriteRect) (byte* frame, const dirtyrect_t* r);
+    void	(*FinishUpdate) (byte* frame);
+
+} videodev_t;
+
+
+// For errors in StartUpdate, WriteRect and FinishUpdate,
+// which may run on the display thread. Raised with I_Error
+// from the game thread, the device call returns meanwhile.
+void I_DisplayError (char* error, ...);
+
+
+// ILI9341 TFT on the Edison GPIO pins, i_tft.c.
+extern videodev_t	tftvideodev;
+
+// No display, optionally dumps frames to files, i_headless.c.
+extern videodev_t	headlessvideodev;
+
+// ILI9341 simulated in memory, counting bus costs, i_tftsim.c.
+extern videodev_t	tftsimvideodev;
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
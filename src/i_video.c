@@ -24,378 +24,301 @@
 static const char
 rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-
-#include <mraa/gpio.h>
+#include <pthread.h>
 
 #include "doomstat.h"
+#include "i_prof.h"
 #include "i_system.h"
+#include "i_viddev.h"
 #include "v_video.h"
 #include "m_argv.h"
 #include "d_main.h"
 
 #include "doomdef.h"
 
-// Edison Arduino pin assignments for TFT controller
-static const int TFT_CS = 9;
-static const int TFT_CD = 8;
-static const int TFT_WR = 7;
-static const int TFT_RD = 6;
-static const int TFT_DATA[8] = { 13, 10, 12, 11, 14, 15, 16, 17 };
-
-// First hardware pin number of the data bits, ie 40-47, and WR flag assumed in the same % 32 range
-static const int TFT_EDISON_DATA0 = 40;
-static const int TFT_EDISON_WR = 48;
-
-// Size of the TFT display, note it's different from SCREENWIDTH/SCREENHEIGHT
-#define TFTWIDTH   240
-#define TFTHEIGHT  320
-
-// Command codes for TFT display controller
-#define ILI9341_SOFTRESET          0x01
-#define ILI9341_SLEEPIN            0x10
-#define ILI9341_SLEEPOUT           0x11
-#define ILI9341_NORMALDISP         0x13
-#define ILI9341_INVERTOFF          0x20
-#define ILI9341_INVERTON           0x21
-#define ILI9341_GAMMASET           0x26
-#define ILI9341_DISPLAYOFF         0x28
-#define ILI9341_DISPLAYON          0x29
-#define ILI9341_COLADDRSET         0x2A
-#define ILI9341_PAGEADDRSET        0x2B
-#define ILI9341_MEMORYWRITE        0x2C
-#define ILI9341_PIXELFORMAT        0x3A
-#define ILI9341_FRAMECONTROL       0xB1
-#define ILI9341_DISPLAYFUNC        0xB6
-#define ILI9341_ENTRYMODE          0xB7
-#define ILI9341_POWERCONTROL1      0xC0
-#define ILI9341_POWERCONTROL2      0xC1
-#define ILI9341_VCOMCONTROL1       0xC5
-#define ILI9341_VCOMCONTROL2       0xC7
-#define ILI9341_GMCTRP1            0xE0
-#define ILI9341_GMCTRN1            0xE1
-#define ILI9341_MEMCONTROL         0x36
-#define ILI9341_MADCTL             0x36
-
-#define ILI9341_MADCTL_MY  0x80
-#define ILI9341_MADCTL_MX  0x40
-#define ILI9341_MADCTL_MV  0x20
-#define ILI9341_MADCTL_ML  0x10
-#define ILI9341_MADCTL_RGB 0x00
-#define ILI9341_MADCTL_BGR 0x08
-#define ILI9341_MADCTL_MH  0x04
-
-
-// Palette to convert from current 8-bit color index to display 16-bit color
-static uint16_t g_palette[256];
-
-// GPIO pins to drive display
-static mraa_gpio_context g_csPinCtx = 0;
-static mraa_gpio_context g_cdPinCtx = 0;
-static mraa_gpio_context g_wrPinCtx = 0;
-static mraa_gpio_context g_rdPinCtx = 0;
-static mraa_gpio_context g_dataPinCtx[8] = { 0 };
-
-// This is an absolute path to a resource file found within sysfs.
-// Might not always be correct. First thing to check if mmap stops
-// working. Check the device for 0x1199 and Intel Vendor (0x8086)
-#define MMAP_PATH "/sys/devices/pci0000:00/0000:00:0c.0/resource0"
-
-// Memory mapped registers to set the data pins faster than through MRAA interface
-static uint8_t *g_MmapRegisterSet = NULL;
-static uint8_t *g_MmapRegisterClear = NULL;
-
-
-// Helper macros to switch GPIO pins
-#define RD_ACTIVE  mraa_gpio_write(g_rdPinCtx, 0)
-#define RD_IDLE    mraa_gpio_write(g_rdPinCtx, 1)
-#define WR_ACTIVE  mraa_gpio_write(g_wrPinCtx, 0)
-#define WR_IDLE    mraa_gpio_write(g_wrPinCtx, 1)
-#define CD_COMMAND mraa_gpio_write(g_cdPinCtx, 0)
-#define CD_DATA    mraa_gpio_write(g_cdPinCtx, 1)
-#define CS_ACTIVE  mraa_gpio_write(g_csPinCtx, 0)
-#define CS_IDLE    mraa_gpio_write(g_csPinCtx, 1)
-
-// Data write strobe, ~2 instructions and always inline
-#define WR_STROBE { uint32_t bit = (uint32_t)((uint32_t)1 << (TFT_EDISON_WR % 32)); \
-	*(volatile uint32_t*)g_MmapRegisterClear = bit; \
-	*(volatile uint32_t*)g_MmapRegisterSet = bit; }
-
-void TFT_MilliSleep(int milliseconds)
+// Available output devices, the first one is the default
+static videodev_t* g_videodevs[] =
+{
+#ifndef NOMRAA
+	&tftvideodev,
+#endif
+	&headlessvideodev,
+	&tftsimvideodev,
+	NULL
+};
+
+static videodev_t* g_videodev = NULL;
+
+// Above this many dirty pixels a single full frame window is sent
+#define FULLFRAME_AREA (SCREENWIDTH * SCREENHEIGHT * 3 / 4)
+
+// Merge changed scanline runs into one window while it wastes fewer
+// pixels than this, about the bus cost of setting up a new window
+#define WINDOW_COST 32
+
+// Current gamma corrected palette, 8-bit R,G,B per color index
+static byte g_palette[256 * 3];
+static boolean g_paletteChanged = false;
+
+// Second framebuffer handed from the game to the display thread, with the
+// regions of it that changed and the palette to show it with.
+// Only touched by the game while the display thread is not busy with it.
+static byte g_frame[SCREENWIDTH * SCREENHEIGHT];
+static dirtyrect_t g_frameRects[MAXDIRTYRECTS];
+static int g_numFrameRects = 0;
+static byte g_framePalette[256 * 3];
+static boolean g_framePaletteChanged = false;
+
+// Display thread streaming g_frame to the device while the next frame renders
+static pthread_t g_displayThread;
+static pthread_mutex_t g_frameMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_frameCond = PTHREAD_COND_INITIALIZER;
+static boolean g_displayThreaded = false;
+static boolean g_frameBusy = false;
+static boolean g_displayQuit = false;
+
+// A device error from the display thread, raised by I_FinishUpdate
+// on the game thread
+static char g_displayError[256];
+
+// Rather than waiting for the display, skip frames while it is busy
+static boolean g_dropFrames = false;
+
+// Copy of the last frame sent to the display, as 8-bit color indices.
+// Only valid while the palette stays the same.
+static byte g_shadow[SCREENWIDTH * SCREENHEIGHT];
+static boolean g_shadowValid = false;
+
+// Changed runs found by comparing a frame against the shadow copy,
+// at most one per scanline of each dirty rectangle
+static dirtyrect_t g_runs[SCREENHEIGHT * MAXDIRTYRECTS];
+static int g_numRuns = 0;
+
+// Compare a dirty rectangle of the frame against the shadow copy, one
+// scanline at a time, and append windows covering the changed runs.
+// Returns the number of pixels in the appended windows.
+int I_DiffRect(const dirtyrect_t* r)
 {
-	usleep(milliseconds * 1000);
+	dirtyrect_t* run = NULL;
+	int width = r->x2 - r->x1 + 1;
+	int area = 0;
+	int y;
+
+	for (y = r->y1; y <= r->y2; y++)
+	{
+		int offset = y * SCREENWIDTH;
+		byte* s = g_frame + offset;
+		byte* d = g_shadow + offset;
+		int x1 = r->x1;
+		int x2 = r->x2;
+
+		if (!memcmp(s + x1, d + x1, width))
+		{
+			run = NULL;
+			continue;
+		}
+
+		while (s[x1] == d[x1])
+			x1++;
+		while (s[x2] == d[x2])
+			x2--;
+
+		// Grow the window of the previous scanline if that is cheaper
+		// than starting a new one
+		if (run)
+		{
+			int ux1 = x1 < run->x1 ? x1 : run->x1;
+			int ux2 = x2 > run->x2 ? x2 : run->x2;
+			int h = run->y2 - run->y1 + 1;
+			int waste = (ux2 - ux1 + 1) * (h + 1)
+					- (run->x2 - run->x1 + 1) * h - (x2 - x1 + 1);
+
+			if (waste <= WINDOW_COST)
+			{
+				area += (ux2 - ux1 + 1) * (h + 1) - (run->x2 - run->x1 + 1) * h;
+				run->x1 = ux1;
+				run->x2 = ux2;
+				run->y2 = y;
+				continue;
+			}
+		}
+
+		run = &g_runs[g_numRuns++];
+		run->x1 = x1;
+		run->y1 = y;
+		run->x2 = x2;
+		run->y2 = y;
+		area += x2 - x1 + 1;
+	}
+
+	return area;
 }
 
-// Initialize a GPIO pin for writing
-mraa_gpio_context TFT_InitPin(int pin)
+// Remember what is now on the display
+void I_UpdateShadow(const dirtyrect_t* r)
 {
-	mraa_gpio_context context = mraa_gpio_init(pin);
-	if (context == NULL)
+	int width = r->x2 - r->x1 + 1;
+	int y;
+	for (y = r->y1; y <= r->y2; y++)
 	{
-		I_Error("Failed to open video display pin %d", pin);
+		int offset = y * SCREENWIDTH + r->x1;
+		memcpy(g_shadow + offset, g_frame + offset, width);
 	}
+}
 
-	mraa_gpio_dir(context, MRAA_GPIO_OUT);
-	mraa_gpio_use_mmaped(context, 1);
-
-	return context;
+//
+// I_UpdateNoBlit
+//
+void I_UpdateNoBlit(void)
+{
+	// what is this?
 }
 
-// Initialize fast access to GPIO via memory mapping the PCI device
-void TFT_InitMmap()
+// Send the handed off frame to the video device
+void I_PushFrame(void)
 {
-	int mmap_fd;
-	if ((mmap_fd = open(MMAP_PATH, O_RDWR)) < 0)
+	static const dirtyrect_t full = { 0, 0, SCREENWIDTH - 1, SCREENHEIGHT - 1 };
+	int i;
+
+	PROF_START(prof_push);
+
+	if (g_framePaletteChanged)
 	{
-		I_Error("Cannot open GPIO device: %s\n", MMAP_PATH);
+		g_videodev->SetPalette(g_framePalette);
+		g_shadowValid = false;
+		g_framePaletteChanged = false;
 	}
 
-	struct stat fd_stat;
-	fstat(mmap_fd, &fd_stat);
+	// Find the runs that really changed since the last frame sent
+	int area = SCREENWIDTH * SCREENHEIGHT;
+	g_numRuns = 0;
+	if (g_shadowValid)
+	{
+		area = 0;
+		for (i = 0; i < g_numFrameRects; i++)
+		{
+			area += I_DiffRect(&g_frameRects[i]);
+		}
+	}
+
+	g_videodev->StartUpdate();
 
-	uint8_t* mmap_reg = (uint8_t*) mmap(NULL, fd_stat.st_size,
-			PROT_READ | PROT_WRITE, MAP_FILE | MAP_SHARED, mmap_fd, 0);
-	if (mmap_reg == MAP_FAILED)
+	if (area >= FULLFRAME_AREA)
 	{
-		I_Error("Failed to mmap GPIO device\n");
+		// Mostly everything changed, one window beats many small ones
+		g_videodev->WriteRect(g_frame, &full);
+	}
+	else
+	{
+		for (i = 0; i < g_numRuns; i++)
+		{
+			g_videodev->WriteRect(g_frame, &g_runs[i]);
+		}
 	}
 
-	uint8_t offset = ((TFT_EDISON_DATA0 / 32) * sizeof(uint32_t));
-	g_MmapRegisterSet = mmap_reg + offset + 0x34;
-	g_MmapRegisterClear = mmap_reg + offset + 0x4c;
-}
+	g_videodev->FinishUpdate(g_frame);
 
+	if (g_shadowValid)
+	{
+		for (i = 0; i < g_numFrameRects; i++)
+		{
+			I_UpdateShadow(&g_frameRects[i]);
+		}
+	}
+	else
+	{
+		I_UpdateShadow(&full);
+		g_shadowValid = true;
+	}
 
-void TFT_Write8(uint8_t value)
-{
-	uint32_t set = (uint32_t) value << (TFT_EDISON_DATA0 % 32);
-	uint32_t clear = ((uint32_t) ((uint8_t) ~value) << (TFT_EDISON_DATA0 % 32))
-			| (uint32_t) 1u << (TFT_EDISON_WR % 32);
-	uint32_t setWr = (uint32_t) 1 << (TFT_EDISON_WR % 32);
-	*(volatile uint32_t*) g_MmapRegisterSet = set;
-	*(volatile uint32_t*) g_MmapRegisterClear = clear;
-	*(volatile uint32_t*) g_MmapRegisterSet = setWr;
+	PROF_STOP(prof_push);
 }
 
-void TFT_Write16(uint16_t value)
+// Copy the changed parts of screens[0] into the second framebuffer.
+// The display thread must not be busy with it.
+void I_HandOffFrame(void)
 {
-	uint8_t hi = value >> 8;
-	uint8_t lo = value;
-
-	uint32_t setHi = (uint32_t) hi << (TFT_EDISON_DATA0 % 32);
-	uint32_t clearHi = ((uint32_t) ((uint8_t) ~hi) << (TFT_EDISON_DATA0 % 32))
-			| (uint32_t) 1 << (TFT_EDISON_WR % 32);
-	uint32_t setLo = (uint32_t) lo << (TFT_EDISON_DATA0 % 32);
-	uint32_t clearLo = ((uint32_t) ((uint8_t) ~lo) << (TFT_EDISON_DATA0 % 32))
-			| (uint32_t) 1 << (TFT_EDISON_WR % 32);
-	uint32_t setWr = (uint32_t) 1 << (TFT_EDISON_WR % 32);
-
-#if RUN_WITHIN_SPEC
-	// The display controller spec wants us to hold the data lines at their steady value
-	// on the transition of WR from low to high for at least 10 ns.
-	// This version will do that:
-	*(volatile uint32_t*)g_MmapRegisterSet = setHi;
-	*(volatile uint32_t*)g_MmapRegisterClear = clearHi;
-	*(volatile uint32_t*)g_MmapRegisterSet = setWr;
-	*(volatile uint32_t*)g_MmapRegisterSet = setLo;
-	*(volatile uint32_t*)g_MmapRegisterClear = clearLo;
-	*(volatile uint32_t*)g_MmapRegisterSet = setWr;
-#else
-	// Disregarding the spec, it seems to "currently" work to merge the WR switch with
-	// the subsequent data write, shaving off two of six write cycles.
-	// If this stops working in the future, it might be fixable by delaying the WR signal
-	// a little, maybe with a capacitor/low pass filterish circuit.
-	*(volatile uint32_t*) g_MmapRegisterSet = setWr | setHi;
-	*(volatile uint32_t*) g_MmapRegisterClear = clearHi;
-	*(volatile uint32_t*) g_MmapRegisterSet = setWr | setLo;
-	*(volatile uint32_t*) g_MmapRegisterClear = clearLo;
-#endif
-}
+	int i;
+	for (i = 0; i < numdirtyrects; i++)
+	{
+		dirtyrect_t* r = &dirtyrects[i];
+		int width = r->x2 - r->x1 + 1;
+		int y;
+		for (y = r->y1; y <= r->y2; y++)
+		{
+			int offset = y * SCREENWIDTH + r->x1;
+			memcpy(g_frame + offset, screens[0] + offset, width);
+		}
+		g_frameRects[i] = *r;
+	}
+	g_numFrameRects = numdirtyrects;
 
-void TFT_WriteRegister8(uint8_t a, uint8_t d)
-{
-	CD_COMMAND;
-	TFT_Write8(a);
-	CD_DATA;
-	TFT_Write8(d);
-}
+	if (g_paletteChanged)
+	{
+		memcpy(g_framePalette, g_palette, sizeof(g_palette));
+		g_framePaletteChanged = true;
+		g_paletteChanged = false;
+	}
 
-void TFT_WriteRegister16(uint8_t a, uint16_t d)
-{
-	CD_COMMAND;
-	TFT_Write8(a);
-	CD_DATA;
-	TFT_Write16(d);
+	V_ClearDirtyRects();
 }
 
-void TFT_WriteRegister32(uint8_t r, uint32_t d)
+static boolean I_OnDisplayThread(void)
 {
-	CD_COMMAND;
-	TFT_Write8(r);
-	CD_DATA;
-	TFT_Write8(d >> 24);
-	TFT_Write8(d >> 16);
-	TFT_Write8(d >> 8);
-	TFT_Write8(d);
+	return g_displayThreaded && pthread_equal(pthread_self(), g_displayThread);
 }
 
-void TFT_InitDisplay()
+// Devices report errors while pushing a frame through here, I_Error
+// shuts the display thread down and must run on the game thread.
+// The device returns and carries on as well as it can.
+void I_DisplayError(char* error, ...)
 {
-	int i;
+	va_list argptr;
+	char msg[sizeof(g_displayError)];
 
-	// Initialize display
-	WR_IDLE;
-	RD_IDLE;
+	va_start(argptr, error);
+	vsnprintf(msg, sizeof(msg), error, argptr);
+	va_end(argptr);
 
-	// Data transfer sync
-	CS_ACTIVE;
-	CD_COMMAND;
-	TFT_Write8(0x00);
-	for (i = 0; i < 3; i++)
-	{
-		WR_STROBE // Three extra 0x00s
-	}
-	CS_IDLE;
-
-	TFT_MilliSleep(200);
-
-	CS_ACTIVE;
-	TFT_WriteRegister8(ILI9341_SOFTRESET, 0);
-	TFT_MilliSleep(50);
-	TFT_WriteRegister8(ILI9341_DISPLAYOFF, 0);
-
-	TFT_WriteRegister8(ILI9341_POWERCONTROL1, 0x23);
-	TFT_WriteRegister8(ILI9341_POWERCONTROL2, 0x10);
-	TFT_WriteRegister16(ILI9341_VCOMCONTROL1, 0x2B2B);
-	TFT_WriteRegister8(ILI9341_VCOMCONTROL2, 0xC0);
-	TFT_WriteRegister8(ILI9341_MEMCONTROL, ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR);
-	TFT_WriteRegister8(ILI9341_PIXELFORMAT, 0x55);
-	TFT_WriteRegister16(ILI9341_FRAMECONTROL, 0x001B);
-
-	TFT_WriteRegister8(ILI9341_ENTRYMODE, 0x07);
-	/* TFT_WriteRegister32(ILI9341_DISPLAYFUNC, 0x0A822700);*/
-
-//	TFT_WriteRegister16(0xF2, 0x00);    // 3Gamma Function Disable
-//	TFT_WriteRegister16(ILI9341_GAMMASET, 0x01);    //Gamma curve selected
-	/*
-	 CD_COMMAND;
-	 TFT_Write8(ILI9341_GMCTRP1);    //Set Gamma
-	 CD_DATA;
-	 #ifdef ADAFRUIT_GAMMA
-	 TFT_Write16(0x0F);
-	 TFT_Write16(0x31);
-	 TFT_Write16(0x2B);
-	 TFT_Write16(0x0C);
-	 TFT_Write16(0x0E);
-	 TFT_Write16(0x08);
-	 TFT_Write16(0x4E);
-	 TFT_Write16(0xF1);
-	 TFT_Write16(0x37);
-	 TFT_Write16(0x07);
-	 TFT_Write16(0x10);
-	 TFT_Write16(0x03);
-	 TFT_Write16(0x0E);
-	 TFT_Write16(0x09);
-	 TFT_Write16(0x00);
-	 #else
-	 // From MI0283QT-11 spec
-	 TFT_Write16(0x001f);
-	 TFT_Write16(0x001a);
-	 TFT_Write16(0x0018);
-	 TFT_Write16(0x000a);
-	 TFT_Write16(0x000f);
-	 TFT_Write16(0x0006);
-	 TFT_Write16(0x0045);
-	 TFT_Write16(0x0087);
-	 TFT_Write16(0x0032);
-	 TFT_Write16(0x000a);
-	 TFT_Write16(0x0007);
-	 TFT_Write16(0x0002);
-	 TFT_Write16(0x0007);
-	 TFT_Write16(0x0005);
-	 TFT_Write16(0x0000);
-	 #endif
-
-	 CD_COMMAND;
-	 TFT_Write8(ILI9341_GMCTRN1);    //Set Gamma
-	 CD_DATA;
-	 #ifdef ADAFRUIT_GAMMA
-	 TFT_Write16(0x00);
-	 TFT_Write16(0x0E);
-	 TFT_Write16(0x14);
-	 TFT_Write16(0x03);
-	 TFT_Write16(0x11);
-	 TFT_Write16(0x07);
-	 TFT_Write16(0x31);
-	 TFT_Write16(0xC1);
-	 TFT_Write16(0x48);
-	 TFT_Write16(0x08);
-	 TFT_Write16(0x0F);
-	 TFT_Write16(0x0C);
-	 TFT_Write16(0x31);
-	 TFT_Write16(0x36);
-	 TFT_Write16(0x0F);
-	 #else
-	 // From MI0283QT-11 spec
-	 TFT_Write16(0x0000);
-	 TFT_Write16(0x0025);
-	 TFT_Write16(0x0027);
-	 TFT_Write16(0x0005);
-	 TFT_Write16(0x0010);
-	 TFT_Write16(0x0009);
-	 TFT_Write16(0x003a);
-	 TFT_Write16(0x0078);
-	 TFT_Write16(0x004d);
-	 TFT_Write16(0x0005);
-	 TFT_Write16(0x0018);
-	 TFT_Write16(0x000d);
-	 TFT_Write16(0x0038);
-	 TFT_Write16(0x003a);
-	 TFT_Write16(0x001f);
-	 #endif
-	 */
-	TFT_WriteRegister8(ILI9341_SLEEPOUT, 0);
-	TFT_MilliSleep(150);
-	TFT_WriteRegister8(ILI9341_DISPLAYON, 0);
-	TFT_MilliSleep(500);
-
-	// Set screen to be rotated to landscape mode
-	TFT_WriteRegister8(ILI9341_MADCTL,
-			ILI9341_MADCTL_MX | ILI9341_MADCTL_MY | ILI9341_MADCTL_MV | ILI9341_MADCTL_BGR); // MADCTL
-
-	// Set full screen as write region (width<->height swapped due to landscape)
-	TFT_WriteRegister32(ILI9341_COLADDRSET, 0 << 16 | (TFTHEIGHT - 1));
-	TFT_WriteRegister32(ILI9341_PAGEADDRSET, 0 << 16 | (TFTWIDTH - 1));
-
-	// Clear screen to black
-	CD_COMMAND;
-	TFT_Write8(0x2C);
-	CD_DATA;
-	for (i = TFTWIDTH * TFTHEIGHT; i; i--)
-	{
-		TFT_Write16(0);
-	}
+	if (!I_OnDisplayThread())
+		I_Error("%s", msg);
 
-	CS_IDLE;
+	pthread_mutex_lock(&g_frameMutex);
+	if (!g_displayError[0])
+		strcpy(g_displayError, msg);
+	pthread_mutex_unlock(&g_frameMutex);
 }
 
-// Pass 8-bit (each) R,G,B, get back 16-bit packed color
-uint16_t I_MakeColor565(uint8_t r, uint8_t g, uint8_t b)
+void* displayThreadMain(void* arg)
 {
-	return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-}
+	pthread_mutex_lock(&g_frameMutex);
+	while (1)
+	{
+		while (!g_frameBusy && !g_displayQuit)
+		{
+			pthread_cond_wait(&g_frameCond, &g_frameMutex);
+		}
+		if (g_displayQuit)
+		{
+			break;
+		}
+		pthread_mutex_unlock(&g_frameMutex);
+
+		I_PushFrame();
+
+		pthread_mutex_lock(&g_frameMutex);
+		g_frameBusy = false;
+		pthread_cond_broadcast(&g_frameCond);
+	}
+	pthread_mutex_unlock(&g_frameMutex);
 
-//
-// I_UpdateNoBlit
-//
-void I_UpdateNoBlit(void)
-{
-	// what is this?
+	return 0;
 }
 
 //
@@ -403,36 +326,42 @@ void I_UpdateNoBlit(void)
 //
 void I_FinishUpdate(void)
 {
-//#define PROFILE_FRAME
-#ifdef PROFILE_FRAME
-	struct timespec t;
-	clock_gettime(CLOCK_REALTIME, &t);
-	double startTime = (double)t.tv_sec + (double)t.tv_nsec / 1.0e9;
-#endif
+	PROF_START(prof_finish);
 
-	CS_ACTIVE;
-	CD_COMMAND;
-	TFT_Write8(0x2C);
-	CD_DATA;
-
-	uint8_t* s = screens[0];
-	int i;
-	for (i = SCREENWIDTH * SCREENHEIGHT; i; i--)
+	if (!g_displayThreaded)
 	{
-		TFT_Write16(g_palette[*s++]);
+		I_HandOffFrame();
+		I_PushFrame();
+	}
+	else
+	{
+		pthread_mutex_lock(&g_frameMutex);
+		if (g_displayError[0])
+		{
+			pthread_mutex_unlock(&g_frameMutex);
+			I_Error("%s", g_displayError);
+		}
+		if (g_frameBusy && g_dropFrames)
+		{
+			// Still showing the last one, drop this frame.
+			// Its dirty rectangles carry over to the next.
+			pthread_mutex_unlock(&g_frameMutex);
+			PROF_STOP(prof_finish);
+			return;
+		}
+		while (g_frameBusy)
+		{
+			pthread_cond_wait(&g_frameCond, &g_frameMutex);
+		}
+
+		I_HandOffFrame();
+
+		g_frameBusy = true;
+		pthread_cond_broadcast(&g_frameCond);
+		pthread_mutex_unlock(&g_frameMutex);
 	}
 
-	CS_IDLE;
-
-#ifdef PROFILE_FRAME
-	clock_gettime(CLOCK_REALTIME, &t);
-	double endTime = (double)t.tv_sec + (double)t.tv_nsec / 1.0e9;
-
-	static double lastEndTime = 0;
-
-	printf("I_Video: Draw time %f, frame time %f\n", endTime - startTime, endTime - lastEndTime);
-	lastEndTime = endTime;
-#endif
+	PROF_STOP(prof_finish);
 }
 
 //
@@ -449,47 +378,83 @@ void I_ReadScreen(byte* scr)
 void I_SetPalette(byte* palette)
 {
 	int i;
-	for (i = 0; i < 256; i++)
+	for (i = 0; i < 256 * 3; i++)
 	{
-		uint8_t r, g, b;
-		r = gammatable[usegamma][*palette++];
-		g = gammatable[usegamma][*palette++];
-		b = gammatable[usegamma][*palette++];
-		g_palette[i] = I_MakeColor565(r, g, b);
+		g_palette[i] = gammatable[usegamma][*palette++];
 	}
+
+	// Every pixel on the display changes color
+	V_MarkRect(0, 0, SCREENWIDTH, SCREENHEIGHT);
+	g_paletteChanged = true;
 }
 
 void I_InitGraphics(void)
 {
+	int p;
+
 	fprintf(stderr, "I_InitGraphics: ");
 
-	// Initialize GPIO pins
-	g_csPinCtx = TFT_InitPin(TFT_CS);
-	g_cdPinCtx = TFT_InitPin(TFT_CD);
-	g_wrPinCtx = TFT_InitPin(TFT_WR);
-	g_rdPinCtx = TFT_InitPin(TFT_RD);
-	int i;
-	for (i = 0; i < 8; ++i)
+	g_videodev = g_videodevs[0];
+
+	p = M_CheckParm("-video");
+	if (p && p < myargc - 1)
 	{
-		g_dataPinCtx[i] = TFT_InitPin(TFT_DATA[i]);
+		int i;
+		for (i = 0; g_videodevs[i]; i++)
+		{
+			if (!strcasecmp(g_videodevs[i]->name, myargv[p + 1]))
+				break;
+		}
+		if (!g_videodevs[i])
+			I_Error("Unknown video device %s", myargv[p + 1]);
+
+		g_videodev = g_videodevs[i];
 	}
 
-	TFT_InitMmap();
+	g_videodev->Init();
 
-	TFT_InitDisplay();
+	g_dropFrames = M_CheckParm("-dropframes");
 
-	fprintf(stderr, " display ready\n");
+	if (!M_CheckParm("-nodisplaythread"))
+	{
+		int err = pthread_create(&g_displayThread, NULL, &displayThreadMain, NULL);
+		if (err != 0)
+			fprintf(stderr, "Can't create display thread: %s\n", strerror(err));
+		else
+			g_displayThreaded = true;
+	}
+
+	fprintf(stderr, " %s display ready\n", g_videodev->name);
 }
 
 void I_ShutdownGraphics(void)
 {
-	mraa_gpio_close(g_csPinCtx);
-	mraa_gpio_close(g_cdPinCtx);
-	mraa_gpio_close(g_wrPinCtx);
-	mraa_gpio_close(g_rdPinCtx);
-	int i;
-	for (i = 0; i < 8; ++i)
+	if (!g_videodev)
+		return;
+
+	if (I_OnDisplayThread())
+	{
+		// An error on the display thread itself, nothing to wait for
+		pthread_mutex_lock(&g_frameMutex);
+		g_displayQuit = true;
+		pthread_mutex_unlock(&g_frameMutex);
+		g_displayThreaded = false;
+	}
+	else if (g_displayThreaded)
 	{
-		mraa_gpio_close(g_dataPinCtx[i]);
+		pthread_mutex_lock(&g_frameMutex);
+		while (g_frameBusy)
+		{
+			pthread_cond_wait(&g_frameCond, &g_frameMutex);
+		}
+		g_displayQuit = true;
+		pthread_cond_broadcast(&g_frameCond);
+		pthread_mutex_unlock(&g_frameMutex);
+
+		pthread_join(g_displayThread, NULL);
+		g_displayThreaded = false;
 	}
+
+	g_videodev->Shutdown();
+	g_videodev = NULL;
 }
@@ -191,6 +191,10 @@ extern int	joybstrafe;
 extern int	joybuse;
 extern int	joybspeed;
 
+extern int	joydeadzone;
+extern int	joycurve;
+extern int	joyrange[2][3];
+
 extern int	viewwidth;
 extern int	viewheight;
 
@@ -205,6 +209,7 @@ extern int	showMessages;
 
 // machine-independent sound params
 extern	int	numChannels;
+extern	int	snd_pitchshift;
 
 
 // UNIX hack, to be removed.
@@ -275,11 +280,20 @@ default_t	defaults[] =
     {"joyb_strafe",&joybstrafe,1},
     {"joyb_use",&joybuse,3},
     {"joyb_speed",&joybspeed,2},
+    {"joy_deadzone",&joydeadzone,15},
+    {"joy_curve",&joycurve,20},
+    {"joy_xmin",&joyrange[0][0],0},
+    {"joy_xcenter",&joyrange[0][1],0},
+    {"joy_xmax",&joyrange[0][2],0},
+    {"joy_ymin",&joyrange[1][0],0},
+    {"joy_ycenter",&joyrange[1][1],0},
+    {"joy_ymax",&joyrange[1][2],0},
 
     {"screenblocks",&screenblocks, 9},
     {"detaillevel",&detailLevel, 0},
 
-    {"snd_channels",&numChannels, 3},
+    {"snd_channels",&numChannels, 8},
+    {"snd_pitchshift",&snd_pitchshift, 0},
 
 
 
@@ -350,6 +350,18 @@ void P_ZMovement (mobj_t* mo)
 
 
 
+//
+// P_SetSpawnAngle
+// A new thing faces its angle from the start,
+//  also under -interpolate.
+//
+static void P_SetSpawnAngle (mobj_t* mo, angle_t angle)
+{
+    mo->angle = angle;
+    mo->oldangle = angle;
+}
+
+
 //
 // P_NightmareRespawn
 //
@@ -397,7 +409,7 @@ P_NightmareRespawn (mobj_t* mobj)
     // inherit attributes from deceased one
     mo = P_SpawnMobj (x,y,z, mobj->type);
     mo->spawnpoint = mobj->spawnpoint;	
-    mo->angle = ANG45 * (mthing->angle/45);
+    P_SetSpawnAngle (mo, ANG45 * (mthing->angle/45));
 
     if (mthing->options & MTF_AMBUSH)
 	mo->flags |= MF_AMBUSH;
@@ -526,6 +538,10 @@ P_SpawnMobj
     else 
 	mobj->z = z;
 
+    mobj->oldx = mobj->x;
+    mobj->oldy = mobj->y;
+    mobj->oldz = mobj->z;
+
     mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker;
 	
     P_AddThinker (&mobj->thinker);
@@ -624,7 +640,7 @@ void P_RespawnSpecials (void)
 
     mo = P_SpawnMobj (x,y,z, i);
     mo->spawnpoint = *mthing;	
-    mo->angle = ANG45 * (mthing->angle/45);
+    P_SetSpawnAngle (mo, ANG45 * (mthing->angle/45));
 
     // pull it from the que
     iquetail = (iquetail+1)&(ITEMQUESIZE-1);
@@ -668,7 +684,7 @@ void P_SpawnPlayer (mapthing_t* mthing)
     if (mthing->type > 1)		
 	mobj->flags |= (mthing->type-1)<<MF_TRANSSHIFT;
 		
-    mobj->angle	= ANG45 * (mthing->angle/45);
+    P_SetSpawnAngle (mobj, ANG45 * (mthing->angle/45));
     mobj->player = p;
     mobj->health = p->health;
 
@@ -681,6 +697,8 @@ void P_SpawnPlayer (mapthing_t* mthing)
     p->extralight = 0;
     p->fixedcolormap = 0;
     p->viewheight = VIEWHEIGHT;
+    p->viewz = mobj->z + VIEWHEIGHT;
+    p->oldviewz = p->viewz;
 
     // setup gun psprite
     P_SetupPsprites (p);
@@ -791,7 +809,7 @@ void P_SpawnMapThing (mapthing_t* mthing)
     if (mobj->flags & MF_COUNTITEM)
 	totalitems++;
 		
-    mobj->angle = ANG45 * (mthing->angle/45);
+    P_SetSpawnAngle (mobj, ANG45 * (mthing->angle/45));
     if (mthing->options & MTF_AMBUSH)
 	mobj->flags |= MF_AMBUSH;
 }
@@ -909,7 +927,7 @@ P_SpawnMissile
     if (dest->flags & MF_SHADOW)
 	an += (P_Random()-P_Random())<<20;	
 
-    th->angle = an;
+    P_SetSpawnAngle (th, an);
     an >>= ANGLETOFINESHIFT;
     th->momx = FixedMul (th->info->speed, finecosine[an]);
     th->momy = FixedMul (th->info->speed, finesine[an]);
@@ -976,7 +994,7 @@ P_SpawnPlayerMissile
 	S_StartSound (th, th->info->seesound);
 
     th->target = source;
-    th->angle = an;
+    P_SetSpawnAngle (th, an);
     th->momx = FixedMul( th->info->speed,
 			 finecosine[an>>ANGLETOFINESHIFT]);
     th->momy = FixedMul( th->info->speed,
@@ -282,6 +282,13 @@ typedef struct mobj_s
 
     // Thing being chased/attacked for tracers.
     struct mobj_s*	tracer;	
+
+    // Where it was before the tic, for -interpolate.
+    // Not saved, keep them last.
+    fixed_t		oldx;
+    fixed_t		oldy;
+    fixed_t		oldz;
+    angle_t		oldangle;
     
 } mobj_t;
 
@@ -24,6 +24,8 @@
 static const char
 rcsid[] = "$Id: p_tick.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 
+#include <stddef.h>
+
 #include "i_system.h"
 #include "z_zone.h"
 #include "p_local.h"
@@ -39,6 +41,11 @@ byte*		save_p;
 //  so that the load/save works on SGI&Gecko.
 #define PADSAVEP()	save_p += (4 - ((int) save_p & 3)) & 3
 
+// The interpolation fields at the end of mobj_t and player_t
+// are not saved, savegames keep their layout
+#define MOBJSAVESIZE	offsetof(mobj_t, oldx)
+#define PLAYERSAVESIZE	offsetof(player_t, oldviewz)
+
 
 
 //
@@ -58,8 +65,8 @@ void P_ArchivePlayers (void)
 	PADSAVEP();
 
 	dest = (player_t *)save_p;
-	memcpy (dest,&players[i],sizeof(player_t));
-	save_p += sizeof(player_t);
+	memcpy (dest,&players[i],PLAYERSAVESIZE);
+	save_p += PLAYERSAVESIZE;
 	for (j=0 ; j<NUMPSPRITES ; j++)
 	{
 	    if (dest->psprites[j].state)
@@ -88,8 +95,9 @@ void P_UnArchivePlayers (void)
 	
 	PADSAVEP();
 
-	memcpy (&players[i],save_p, sizeof(player_t));
-	save_p += sizeof(player_t);
+	memcpy (&players[i],save_p, PLAYERSAVESIZE);
+	save_p += PLAYERSAVESIZE;
+	players[i].oldviewz = players[i].viewz;
 	
 	// will be set when unarc thinker
 	players[i].mo = NULL;	
@@ -242,8 +250,8 @@ void P_ArchiveThinkers (void)
 	    *save_p++ = tc_mobj;
 	    PADSAVEP();
 	    mobj = (mobj_t *)save_p;
-	    memcpy (mobj, th, sizeof(*mobj));
-	    save_p += sizeof(*mobj);
+	    memcpy (mobj, th, MOBJSAVESIZE);
+	    save_p += MOBJSAVESIZE;
 	    mobj->state = (state_t *)(mobj->state - states);
 	    
 	    if (mobj->player)
@@ -297,8 +305,12 @@ void P_UnArchiveThinkers (void)
 	  case tc_mobj:
 	    PADSAVEP();
 	    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
-	    memcpy (mobj, save_p, sizeof(*mobj));
-	    save_p += sizeof(*mobj);
+	    memcpy (mobj, save_p, MOBJSAVESIZE);
+	    save_p += MOBJSAVESIZE;
+	    mobj->oldx = mobj->x;
+	    mobj->oldy = mobj->y;
+	    mobj->oldz = mobj->z;
+	    mobj->oldangle = mobj->angle;
 	    mobj->state = &states[(int)mobj->state];
 	    mobj->target = NULL;
 	    if (mobj->player)
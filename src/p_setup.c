@@ -606,6 +606,9 @@ P_SetupLevel
     // Make sure all sounds are stopped before Z_FreeTags.
     S_Start ();			
 
+    // And that the render thread is done with the level.
+    R_WaitView ();
+
     
 #if 0 // UNUSED
     if (debugfile)
@@ -680,6 +683,9 @@ P_SetupLevel
 	
     // set up world state
     P_SpawnSpecials ();
+
+    // what the refresh draws from
+    R_SetupSnapshots ();
 	
     // build subsector connect matrix
     //	UNUSED P_ConnectSubsectors ();
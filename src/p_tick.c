@@ -26,6 +26,7 @@ static const char
 rcsid[] = "$Id: p_tick.c,v 1.4 1997/02/03 16:47:55 b1 Exp $";
 
 #include "z_zone.h"
+#include "i_system.h"
 #include "p_local.h"
 
 #include "doomstat.h"
@@ -123,6 +124,34 @@ void P_RunThinkers (void)
 
 
 
+//
+// P_StoreOldPositions
+// Where things and views are before the tic, for the
+// renderer to interpolate from
+//
+void P_StoreOldPositions (void)
+{
+    thinker_t*	th;
+    mobj_t*	mo;
+    int		i;
+
+    for (th = thinkercap.next ; th != &thinkercap ; th = th->next)
+    {
+	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
+	    continue;
+
+	mo = (mobj_t *)th;
+	mo->oldx = mo->x;
+	mo->oldy = mo->y;
+	mo->oldz = mo->z;
+	mo->oldangle = mo->angle;
+    }
+
+    for (i=0 ; i<MAXPLAYERS ; i++)
+	players[i].oldviewz = players[i].viewz;
+}
+
+
 //
 // P_Ticker
 //
@@ -130,29 +159,32 @@ void P_RunThinkers (void)
 void P_Ticker (void)
 {
     int		i;
+
+    // also when paused, so nothing moves
+    if (g_interpolate)
+	P_StoreOldPositions ();
     
-    // run the tic
-    if (paused)
-	return;
-		
-    // pause if in menu and at least one tic has been run
-    if ( !netgame
-	 && menuactive
-	 && !demoplayback
-	 && players[consoleplayer].viewz != 1)
+    // run the tic, unless paused,
+    // or in menu and at least one tic has been run
+    if (!paused
+	&& ( netgame
+	     || !menuactive
+	     || demoplayback
+	     || players[consoleplayer].viewz == 1))
     {
-	return;
-    }
-    
-		
-    for (i=0 ; i<MAXPLAYERS ; i++)
-	if (playeringame[i])
-	    P_PlayerThink (&players[i]);
+	for (i=0 ; i<MAXPLAYERS ; i++)
+	    if (playeringame[i])
+		P_PlayerThink (&players[i]);
 			
-    P_RunThinkers ();
-    P_UpdateSpecials ();
-    P_RespawnSpecials ();
+	P_RunThinkers ();
+	P_UpdateSpecials ();
+	P_RespawnSpecials ();
+
+	// for par times
+	leveltime++;	
+    }
 
-    // for par times
-    leveltime++;	
+    // for the render thread to draw while the next tic runs
+    if (r_threaded)
+	R_SnapshotTic ();
 }
@@ -45,10 +45,10 @@ rcsid[] = "$Id: r_bsp.c,v 1.4 1997/02/03 22:45:12 b1 Exp $";
 
 
 seg_t*		curline;
-side_t*		sidedef;
+snapside_t*	sidedef;
 line_t*		linedef;
-sector_t*	frontsector;
-sector_t*	backsector;
+snapsector_t*	frontsector;
+snapsector_t*	backsector;
 
 drawseg_t	drawsegs[MAXDRAWSEGS];
 drawseg_t*	ds_p;
@@ -317,7 +317,7 @@ void R_AddLine (seg_t*	line)
     if (x1 == x2)
 	return;				
 	
-    backsector = line->backsector;
+    backsector = line->backsector ? R_SnapSector (line->backsector) : NULL;
 
     // Single sided line?
     if (!backsector)
@@ -341,7 +341,7 @@ void R_AddLine (seg_t*	line)
     if (backsector->ceilingpic == frontsector->ceilingpic
 	&& backsector->floorpic == frontsector->floorpic
 	&& backsector->lightlevel == frontsector->lightlevel
-	&& curline->sidedef->midtexture == 0)
+	&& R_SnapSide (curline->sidedef)->midtexture == 0)
     {
 	return;
     }
@@ -509,7 +509,7 @@ void R_Subsector (int num)
 
     sscount++;
     sub = &subsectors[num];
-    frontsector = sub->sector;
+    frontsector = R_SnapSector (sub->sector);
     count = sub->numlines;
     line = &segs[sub->firstline];
 
@@ -23,16 +23,18 @@
 #ifndef __R_BSP__
 #define __R_BSP__
 
+#include "r_snap.h"
+
 #ifdef __GNUG__
 #pragma interface
 #endif
 
 
 extern seg_t*		curline;
-extern side_t*		sidedef;
+extern snapside_t*	sidedef;
 extern line_t*		linedef;
-extern sector_t*	frontsector;
-extern sector_t*	backsector;
+extern snapsector_t*	frontsector;
+extern snapsector_t*	backsector;
 
 extern int		rw_x;
 extern int		rw_stopx;
@@ -233,17 +233,15 @@ void R_DrawColumnLow (void)
     //	dccount++; 
 #endif 
     // Blocky mode, need to multiply by 2.
-    dc_x <<= 1;
-    
-    dest = ylookup[dc_yl] + columnofs[dc_x];
-    dest2 = ylookup[dc_yl] + columnofs[dc_x+1];
+    // Not in dc_x, R_DrawVisSprite steps it.
+    dest = ylookup[dc_yl] + columnofs[dc_x<<1];
+    dest2 = dest + 1;
     
     fracstep = dc_iscale; 
     frac = dc_texturemid + (dc_yl-centery)*fracstep;
     
     do 
     {
-	// Hack. Does not work corretly.
 	*dest2 = *dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
 	dest += SCREENWIDTH;
 	dest2 += SCREENWIDTH;
@@ -366,7 +364,60 @@ void R_DrawFuzzColumn (void)
 	frac += fracstep; 
     } while (count--); 
 } 
- 
+
+
+
+//
+// R_DrawFuzzColumnLow
+// Blocky mode version, every column
+//  fuzzes a pair of pixels.
+//
+void R_DrawFuzzColumnLow (void) 
+{ 
+    int			count; 
+    byte*		dest; 
+    byte*		dest2; 
+
+    // Adjust borders. Low... 
+    if (!dc_yl) 
+	dc_yl = 1;
+
+    // .. and high.
+    if (dc_yh == viewheight-1) 
+	dc_yh = viewheight - 2; 
+		 
+    count = dc_yh - dc_yl; 
+
+    // Zero length.
+    if (count < 0) 
+	return; 
+
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH/2
+	|| dc_yl < 0 || dc_yh >= SCREENHEIGHT)
+    {
+	I_Error ("R_DrawFuzzColumnLow: %i to %i at %i",
+		 dc_yl, dc_yh, dc_x);
+    }
+#endif
+
+    dest = ylookup[dc_yl] + columnofs[dc_x<<1];
+    dest2 = dest + 1;
+
+    do 
+    {
+	*dest = colormaps[6*256+dest[fuzzoffset[fuzzpos]]]; 
+	*dest2 = colormaps[6*256+dest2[fuzzoffset[fuzzpos]]]; 
+
+	// Clamp table lookup index.
+	if (++fuzzpos == FUZZTABLE) 
+	    fuzzpos = 0;
+	
+	dest += SCREENWIDTH;
+	dest2 += SCREENWIDTH;
+    } while (count--); 
+} 
+
   
  
 
@@ -448,6 +499,50 @@ void R_DrawTranslatedColumn (void)
 
 
 
+//
+// R_DrawTranslatedColumnLow
+// Blocky mode version.
+//
+void R_DrawTranslatedColumnLow (void) 
+{ 
+    int			count; 
+    byte*		dest; 
+    byte*		dest2; 
+    fixed_t		frac;
+    fixed_t		fracstep;	 
+ 
+    count = dc_yh - dc_yl; 
+    if (count < 0) 
+	return; 
+				 
+#ifdef RANGECHECK 
+    if ((unsigned)dc_x >= SCREENWIDTH/2
+	|| dc_yl < 0
+	|| dc_yh >= SCREENHEIGHT)
+    {
+	I_Error ( "R_DrawTranslatedColumnLow: %i to %i at %i",
+		  dc_yl, dc_yh, dc_x);
+    }
+#endif 
+
+    dest = ylookup[dc_yl] + columnofs[dc_x<<1]; 
+    dest2 = dest + 1;
+
+    fracstep = dc_iscale; 
+    frac = dc_texturemid + (dc_yl-centery)*fracstep; 
+
+    do 
+    {
+	*dest2 = *dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
+	dest += SCREENWIDTH;
+	dest2 += SCREENWIDTH;
+	
+	frac += fracstep; 
+    } while (count--); 
+} 
+
+
+
 
 //
 // R_InitTranslationTables
@@ -664,10 +759,8 @@ void R_DrawSpanLow (void)
     yfrac = ds_yfrac; 
 
     // Blocky mode, need to multiply by 2.
-    ds_x1 <<= 1;
-    ds_x2 <<= 1;
-    
-    dest = ylookup[ds_y] + columnofs[ds_x1];
+    // Count source pixels, each is written twice.
+    dest = ylookup[ds_y] + columnofs[ds_x1<<1];
   
     
     count = ds_x2 - ds_x1; 
@@ -676,8 +769,8 @@ void R_DrawSpanLow (void)
 	spot = ((yfrac>>(16-6))&(63*64)) + ((xfrac>>16)&63);
 	// Lowres/blocky mode does it twice,
 	//  while scale is adjusted appropriately.
-	*dest++ = ds_colormap[ds_source[spot]]; 
-	*dest++ = ds_colormap[ds_source[spot]];
+	dest[0] = dest[1] = ds_colormap[ds_source[spot]]; 
+	dest += 2;
 	
 	xfrac += ds_xstep; 
 	yfrac += ds_ystep; 
@@ -32,6 +32,9 @@
 // Include the refresh/render data structs.
 #include "r_data.h"
 
+// What the refresh draws from.
+#include "r_snap.h"
+
 
 
 //
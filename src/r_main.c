@@ -34,12 +34,15 @@ static const char rcsid[] = "$Id: r_main.c,v 1.5 1997/02/03 22:45:12 b1 Exp $";
 
 #include "doomdef.h"
 #include "d_net.h"
+#include "i_prof.h"
 
 #include "m_bbox.h"
 
 #include "r_local.h"
 #include "r_sky.h"
 
+#include "doomstat.h"
+
 
 
 
@@ -288,14 +291,17 @@ R_PointOnSegSide
 
 
 
-angle_t
-R_PointToAngle
+//
+// R_AngleTo
+// Of the offset x,y. The game thread finds angles
+//  with R_PointToAngle2 while the render thread draws,
+//  so neither goes through viewx and viewy.
+//
+static angle_t
+R_AngleTo
 ( fixed_t	x,
   fixed_t	y )
 {	
-    x -= viewx;
-    y -= viewy;
-    
     if ( (!x) && (!y) )
 	return 0;
 
@@ -374,6 +380,15 @@ R_PointToAngle
 }
 
 
+angle_t
+R_PointToAngle
+( fixed_t	x,
+  fixed_t	y )
+{	
+    return R_AngleTo (x - viewx, y - viewy);
+}
+
+
 angle_t
 R_PointToAngle2
 ( fixed_t	x1,
@@ -381,10 +396,7 @@ R_PointToAngle2
   fixed_t	x2,
   fixed_t	y2 )
 {	
-    viewx = x1;
-    viewy = y1;
-    
-    return R_PointToAngle (x2, y2);
+    return R_AngleTo (x2 - x1, y2 - y1);
 }
 
 
@@ -677,6 +689,8 @@ void R_ExecuteSetViewSize (void)
     int		level;
     int		startmap; 	
 
+    // a view the render thread drew is the old size
+    R_DropView ();
     setsizeneeded = false;
 
     if (setblocks == 11)
@@ -709,8 +723,8 @@ void R_ExecuteSetViewSize (void)
     else
     {
 	colfunc = basecolfunc = R_DrawColumnLow;
-	fuzzcolfunc = R_DrawFuzzColumn;
-	transcolfunc = R_DrawTranslatedColumn;
+	fuzzcolfunc = R_DrawFuzzColumnLow;
+	transcolfunc = R_DrawTranslatedColumnLow;
 	spanfunc = R_DrawSpanLow;
     }
 
@@ -789,6 +803,7 @@ void R_Init (void)
     printf ("\nR_InitSkyMap");
     R_InitTranslationTables ();
     printf ("\nR_InitTranslationsTables");
+    R_InitSnapshots ();
 	
     framecount = 0;
 }
@@ -824,31 +839,58 @@ R_PointInSubsector
 
 
 
+//
+// R_Lerp
+// Under -interpolate, frames between tics show things on
+// the way from where they were to where they are
+//
+fixed_t		r_ticfrac = FRACUNIT;
+
+fixed_t R_Lerp (fixed_t from, fixed_t to)
+{
+    if (r_ticfrac == FRACUNIT)
+	return to;
+    return from + FixedMul (to - from, r_ticfrac);
+}
+
+angle_t R_LerpAngle (angle_t from, angle_t to)
+{
+    if (r_ticfrac == FRACUNIT)
+	return to;
+    // the short way round
+    return from + FixedMul ((int)(to - from), r_ticfrac);
+}
+
+
 //
 // R_SetupFrame
 //
-void R_SetupFrame (player_t* player)
+void R_SetupFrame (void)
 {		
     int		i;
+    snapview_t*	view = &r_snap->view;
     
-    viewplayer = player;
-    viewx = player->mo->x;
-    viewy = player->mo->y;
-    viewangle = player->mo->angle + viewangleoffset;
-    extralight = player->extralight;
-
-    viewz = player->viewz;
+    viewx = R_Lerp (view->oldx, view->x);
+    viewy = R_Lerp (view->oldy, view->y);
+    viewangle = R_LerpAngle (view->oldangle, view->angle) + viewangleoffset;
+    extralight = view->extralight;
+
+    // the first tic of a level sets the view height up
+    if (view->lerpviewz)
+	viewz = R_Lerp (view->oldviewz, view->viewz);
+    else
+	viewz = view->viewz;
     
     viewsin = finesine[viewangle>>ANGLETOFINESHIFT];
     viewcos = finecosine[viewangle>>ANGLETOFINESHIFT];
 	
     sscount = 0;
 	
-    if (player->fixedcolormap)
+    if (view->fixedcolormap)
     {
 	fixedcolormap =
 	    colormaps
-	    + player->fixedcolormap*256*sizeof(lighttable_t);
+	    + view->fixedcolormap*256*sizeof(lighttable_t);
 	
 	walllights = scalelightfixed;
 
@@ -858,18 +900,21 @@ void R_SetupFrame (player_t* player)
     else
 	fixedcolormap = 0;
 		
+    // R_AddSprites marks the snapshot sectors with it
     framecount++;
-    validcount++;
 }
 
 
 
 //
 // R_RenderView
+// Draws r_snap. The render thread leaves NetUpdate to
+//  the game thread.
 //
-void R_RenderPlayerView (player_t* player)
+void R_RenderView (boolean netupdate)
 {	
-    R_SetupFrame (player);
+    PROF_START (prof_render);
+    R_SetupFrame ();
 
     // Clear buffers.
     R_ClearClipSegs ();
@@ -878,21 +923,48 @@ void R_RenderPlayerView (player_t* player)
     R_ClearSprites ();
     
     // check for new console commands.
-    NetUpdate ();
+    if (netupdate)
+	NetUpdate ();
 
     // The head node is the last node output.
+    PROF_START (prof_bsp);
     R_RenderBSPNode (numnodes-1);
+    PROF_STOP (prof_bsp);
     
     // Check for new console commands.
-    NetUpdate ();
+    if (netupdate)
+	NetUpdate ();
     
+    PROF_START (prof_planes);
     R_DrawPlanes ();
+    PROF_STOP (prof_planes);
     
     // Check for new console commands.
-    NetUpdate ();
+    if (netupdate)
+	NetUpdate ();
     
+    PROF_START (prof_masked);
     R_DrawMasked ();
+    PROF_STOP (prof_masked);
 
     // Check for new console commands.
-    NetUpdate ();				
+    if (netupdate)
+	NetUpdate ();				
+    PROF_STOP (prof_render);
+}
+
+
+//
+// R_RenderPlayerView
+//
+void R_RenderPlayerView (player_t* player)
+{	
+    viewplayer = player;
+
+    // the render thread drew it while the tics ran
+    if (R_ViewDrawn ())
+	return;
+
+    R_TakeSnapshot (player);
+    R_RenderView (true);
 }
@@ -100,6 +100,7 @@ extern	int		detailshift;
 extern void		(*colfunc) (void);
 extern void		(*basecolfunc) (void);
 extern void		(*fuzzcolfunc) (void);
+extern void		(*transcolfunc) (void);
 // No shadow effects on floors.
 extern void		(*spanfunc) (void);
 
@@ -158,6 +159,17 @@ R_AddPointToBox
 // Called by G_Drawer.
 void R_RenderPlayerView (player_t *player);
 
+// Draws r_snap, on either thread.
+void R_RenderView (boolean netupdate);
+
+// How far into the tic the frame is drawn, FRACUNIT unless
+// interpolating. Set by D_Display.
+extern fixed_t	r_ticfrac;
+
+// Between the value before the tic and now, at r_ticfrac.
+fixed_t R_Lerp (fixed_t from, fixed_t to);
+angle_t R_LerpAngle (angle_t from, angle_t to);
+
 // Called by startup code.
 void R_Init (void);
 
@@ -412,7 +412,7 @@ void R_DrawPlanes (void)
 		{
 		    angle = (viewangle + xtoviewangle[x])>>ANGLETOSKYSHIFT;
 		    dc_x = x;
-		    dc_source = R_GetColumn(skytexture, angle);
+		    dc_source = R_GetColumn(r_snap->view.skytexture, angle);
 		    colfunc ();
 		}
 	    }
@@ -421,7 +421,7 @@ void R_DrawPlanes (void)
 	
 	// regular flat
 	ds_source = W_CacheLumpNum(firstflat +
-				   flattranslation[pl->picnum],
+				   r_snap->flattranslation[pl->picnum],
 				   PU_STATIC);
 	
 	planeheight = abs(pl->height-viewz);
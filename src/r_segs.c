@@ -115,9 +115,9 @@ R_RenderMaskedSegRange
     //   for horizontal / vertical / diagonal. Diagonal?
     // OPTIMIZE: get rid of LIGHTSEGSHIFT globally
     curline = ds->curline;
-    frontsector = curline->frontsector;
-    backsector = curline->backsector;
-    texnum = texturetranslation[curline->sidedef->midtexture];
+    frontsector = R_SnapSector (curline->frontsector);
+    backsector = R_SnapSector (curline->backsector);
+    texnum = r_snap->texturetranslation[R_SnapSide (curline->sidedef)->midtexture];
 	
     lightnum = (frontsector->lightlevel >> LIGHTSEGSHIFT)+extralight;
 
@@ -153,7 +153,7 @@ R_RenderMaskedSegRange
 	    ? frontsector->ceilingheight : backsector->ceilingheight;
 	dc_texturemid = dc_texturemid - viewz;
     }
-    dc_texturemid += curline->sidedef->rowoffset;
+    dc_texturemid += R_SnapSide (curline->sidedef)->rowoffset;
 			
     if (fixedcolormap)
 	dc_colormap = fixedcolormap;
@@ -391,7 +391,7 @@ R_StoreWallRange
 	I_Error ("Bad R_RenderWallRange: %i to %i", start , stop);
 #endif
     
-    sidedef = curline->sidedef;
+    sidedef = R_SnapSide (curline->sidedef);
     linedef = curline->linedef;
 
     // mark the segment as visible for auto map
@@ -456,7 +456,7 @@ R_StoreWallRange
     if (!backsector)
     {
 	// single sided line
-	midtexture = texturetranslation[sidedef->midtexture];
+	midtexture = r_snap->texturetranslation[sidedef->midtexture];
 	// a single sided line is terminal, so it must mark ends
 	markfloor = markceiling = true;
 	if (linedef->flags & ML_DONTPEGBOTTOM)
@@ -570,7 +570,7 @@ R_StoreWallRange
 	if (worldhigh < worldtop)
 	{
 	    // top texture
-	    toptexture = texturetranslation[sidedef->toptexture];
+	    toptexture = r_snap->texturetranslation[sidedef->toptexture];
 	    if (linedef->flags & ML_DONTPEGTOP)
 	    {
 		// top of texture at top
@@ -589,7 +589,7 @@ R_StoreWallRange
 	if (worldlow > worldbottom)
 	{
 	    // bottom texture
-	    bottomtexture = texturetranslation[sidedef->bottomtexture];
+	    bottomtexture = r_snap->texturetranslation[sidedef->bottomtexture];
 
 	    if (linedef->flags & ML_DONTPEGBOTTOM )
 	    {
@@ -0,0 +1,374 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// $Log:$
+//
+// DESCRIPTION:
+//	Snapshots of the level for the refresh, and the render
+//	thread of -rthread.
+//
+//-----------------------------------------------------------------------------
+
+static const char
+rcsid[] = "$Id:$";
+
+#include <pthread.h>
+#include <string.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "m_argv.h"
+#include "i_system.h"
+#include "z_zone.h"
+
+#include "r_local.h"
+#include "r_sky.h"
+
+#ifdef __GNUG__
+#pragma implementation "r_snap.h"
+#endif
+#include "r_snap.h"
+
+
+extern int		numtextures;
+extern int		numflats;
+extern boolean		setsizeneeded;
+
+
+//
+// Two snapshots under -rthread: R_SnapshotTic fills
+//  snapshots[backsnap] while the render thread draws r_snap,
+//  the other one. R_StartView swaps them.
+//
+static snapshot_t	snapshots[2];
+static int		backsnap;
+static boolean		backfresh;
+
+snapshot_t*		r_snap = &snapshots[0];
+
+boolean			r_threaded;
+
+// The render thread
+static pthread_t	viewthread;
+static pthread_mutex_t	viewlock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	viewcond = PTHREAD_COND_INITIALIZER;
+static boolean		viewbusy;
+static boolean		viewdrawn;
+
+
+
+//
+// R_Snapshot
+//
+static void R_Snapshot (snapshot_t* snap, player_t* player)
+{
+    int			i;
+    sector_t*		sec;
+    side_t*		side;
+    mobj_t*		mo;
+    mobj_t*		thing;
+    snapsector_t*	ssec;
+    snapside_t*		sside;
+    snapthing_t*	sthing;
+    snapview_t*		view;
+    pspdef_t*		psp;
+    snapthing_t*	things;
+
+    mo = player->mo;
+    view = &snap->view;
+
+    view->x = mo->x;
+    view->y = mo->y;
+    view->oldx = mo->oldx;
+    view->oldy = mo->oldy;
+    view->angle = mo->angle;
+    view->oldangle = mo->oldangle;
+    view->viewz = player->viewz;
+    view->oldviewz = player->oldviewz;
+    view->lerpviewz = leveltime > 1;
+    view->extralight = player->extralight;
+    view->fixedcolormap = player->fixedcolormap;
+    view->shadow = player->powers[pw_invisibility] > 4*32
+	|| player->powers[pw_invisibility] & 8;
+    view->lightlevel = mo->subsector->sector->lightlevel;
+    view->skytexture = skytexture;
+
+    for (i=0, psp=player->psprites ; i<NUMPSPRITES ; i++, psp++)
+    {
+	if (psp->state)
+	{
+	    view->psprites[i].sprite = psp->state->sprite;
+	    view->psprites[i].frame = psp->state->frame;
+	}
+	else
+	    view->psprites[i].sprite = -1;
+	view->psprites[i].sx = psp->sx;
+	view->psprites[i].sy = psp->sy;
+    }
+
+    memcpy (snap->texturetranslation, texturetranslation,
+	    (numtextures+1)*sizeof(int));
+    memcpy (snap->flattranslation, flattranslation,
+	    (numflats+1)*sizeof(int));
+
+    for (i=0, side=sides, sside=snap->sides ; i<numsides ; i++, side++, sside++)
+    {
+	sside->textureoffset = side->textureoffset;
+	sside->rowoffset = side->rowoffset;
+	sside->toptexture = side->toptexture;
+	sside->bottomtexture = side->bottomtexture;
+	sside->midtexture = side->midtexture;
+    }
+
+    snap->numthings = 0;
+    for (i=0, sec=sectors, ssec=snap->sectors ; i<numsectors ; i++, sec++, ssec++)
+    {
+	ssec->floorheight = sec->floorheight;
+	ssec->ceilingheight = sec->ceilingheight;
+	ssec->floorpic = sec->floorpic;
+	ssec->ceilingpic = sec->ceilingpic;
+	ssec->lightlevel = sec->lightlevel;
+	ssec->firstthing = snap->numthings;
+	ssec->validcount = 0;
+
+	for (thing = sec->thinglist ; thing ; thing = thing->snext)
+	{
+	    if (snap->numthings == snap->maxthings)
+	    {
+		// grow by half
+		snap->maxthings = snap->maxthings ? snap->maxthings*3/2 : 128;
+		things = Z_Malloc (snap->maxthings*sizeof(*things), PU_LEVEL, 0);
+		if (snap->things)
+		{
+		    memcpy (things, snap->things, snap->numthings*sizeof(*things));
+		    Z_Free (snap->things);
+		}
+		snap->things = things;
+	    }
+
+	    sthing = &snap->things[snap->numthings++];
+	    sthing->x = thing->x;
+	    sthing->y = thing->y;
+	    sthing->z = thing->z;
+	    sthing->oldx = thing->oldx;
+	    sthing->oldy = thing->oldy;
+	    sthing->oldz = thing->oldz;
+	    sthing->angle = thing->angle;
+	    sthing->oldangle = thing->oldangle;
+	    sthing->sprite = thing->sprite;
+	    sthing->frame = thing->frame;
+	    sthing->flags = thing->flags;
+	}
+
+	ssec->numthings = snap->numthings - ssec->firstthing;
+    }
+
+    snap->valid = true;
+}
+
+
+//
+// R_TakeSnapshot
+//
+void R_TakeSnapshot (player_t* player)
+{
+    R_Snapshot (r_snap, player);
+}
+
+
+//
+// R_SnapshotTic
+// Called at the end of P_Ticker, also when paused so the
+//  view holds still under -interpolate.
+//
+void R_SnapshotTic (void)
+{
+    if (!players[displayplayer].mo)
+	return;
+
+    R_Snapshot (&snapshots[backsnap], &players[displayplayer]);
+    backfresh = true;
+}
+
+
+//
+// R_ViewThread
+//
+static void* R_ViewThread (void* arg)
+{
+    pthread_mutex_lock (&viewlock);
+    while (1)
+    {
+	while (!viewbusy)
+	    pthread_cond_wait (&viewcond, &viewlock);
+	pthread_mutex_unlock (&viewlock);
+
+	// the textures and sprites drawn from stay cached
+	Z_HoldPurge (R_WaitView);
+	R_RenderView (false);
+	Z_HoldPurge (NULL);
+
+	pthread_mutex_lock (&viewlock);
+	viewbusy = false;
+	viewdrawn = true;
+	pthread_cond_broadcast (&viewcond);
+    }
+
+    return NULL;
+}
+
+
+//
+// R_StartView
+// The view goes where the last one was, D_Display then
+//  draws around it. Nothing else draws there until then.
+//
+void R_StartView (void)
+{
+    if (!r_threaded)
+	return;
+
+    pthread_mutex_lock (&viewlock);
+    if (viewbusy)
+    {
+	pthread_mutex_unlock (&viewlock);
+	return;
+    }
+    viewdrawn = false;
+
+    if (gamestate != GS_LEVEL
+	|| automapactive
+	|| !gametic
+	|| setsizeneeded)
+    {
+	pthread_mutex_unlock (&viewlock);
+	return;
+    }
+
+    if (backfresh)
+    {
+	r_snap = &snapshots[backsnap];
+	backsnap ^= 1;
+	backfresh = false;
+    }
+
+    if (r_snap->valid)
+    {
+	viewbusy = true;
+	pthread_cond_broadcast (&viewcond);
+    }
+    pthread_mutex_unlock (&viewlock);
+}
+
+
+//
+// R_WaitView
+//
+void R_WaitView (void)
+{
+    if (!r_threaded)
+	return;
+
+    pthread_mutex_lock (&viewlock);
+    while (viewbusy)
+	pthread_cond_wait (&viewcond, &viewlock);
+    pthread_mutex_unlock (&viewlock);
+}
+
+
+//
+// R_ViewDrawn
+// Called after R_WaitView.
+//
+boolean R_ViewDrawn (void)
+{
+    boolean	drawn;
+
+    drawn = viewdrawn;
+    viewdrawn = false;
+    return drawn;
+}
+
+
+//
+// R_DropView
+//
+void R_DropView (void)
+{
+    R_WaitView ();
+    viewdrawn = false;
+}
+
+
+//
+// R_SetupSnapshots
+// The level arrays, freed with the level.
+//
+void R_SetupSnapshots (void)
+{
+    int		i;
+
+    // the render thread is done with the last level,
+    //  P_SetupLevel waited for it
+    viewdrawn = false;
+    backfresh = false;
+
+    for (i=0 ; i<(r_threaded ? 2 : 1) ; i++)
+    {
+	snapshots[i].sectors = Z_Malloc (numsectors*sizeof(snapsector_t),
+					 PU_LEVEL, 0);
+	snapshots[i].sides = Z_Malloc (numsides*sizeof(snapside_t),
+				       PU_LEVEL, 0);
+	snapshots[i].things = NULL;
+	snapshots[i].numthings = 0;
+	snapshots[i].maxthings = 0;
+	snapshots[i].valid = false;
+    }
+}
+
+
+//
+// R_InitSnapshots
+//
+void R_InitSnapshots (void)
+{
+    int		i;
+    int		err;
+
+    r_threaded = M_CheckParm ("-rthread") != 0;
+
+    for (i=0 ; i<(r_threaded ? 2 : 1) ; i++)
+    {
+	snapshots[i].texturetranslation =
+	    Z_Malloc ((numtextures+1)*sizeof(int), PU_STATIC, 0);
+	snapshots[i].flattranslation =
+	    Z_Malloc ((numflats+1)*sizeof(int), PU_STATIC, 0);
+    }
+
+    if (!r_threaded)
+	return;
+
+    err = pthread_create (&viewthread, NULL, R_ViewThread, NULL);
+    if (err)
+    {
+	printf ("\nR_InitSnapshots: no render thread: %s", strerror (err));
+	r_threaded = false;
+	return;
+    }
+
+    r_snap = &snapshots[1];
+    printf ("\nR_InitSnapshots: drawing on a render thread");
+}
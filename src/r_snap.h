@@ -0,0 +1,200 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id:$
+//
+// Copyright (C) 1993-1996 by id Software, Inc.
+//
+// This source is available for distribution and/or modification
+// only under the terms of the DOOM Source Code License as
+// published by id Software. All rights reserved.
+//
+// The source is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// FITNESS FOR A PARTICULAR PURPOSE. See the DOOM Source Code License
+// for more details.
+//
+// DESCRIPTION:
+//	Snapshots of what the refresh draws, so it never reads
+//	the live level. With -rthread they are taken at the end
+//	of each tic and a second thread draws tic N while the
+//	game runs N+1.
+//
+//-----------------------------------------------------------------------------
+
+
+#ifndef __R_SNAP__
+#define __R_SNAP__
+
+#include "d_player.h"
+#include "r_defs.h"
+
+
+#ifdef __GNUG__
+#pragma interface
+#endif
+
+
+//
+// The parts of a sector the refresh reads,
+//  named as in sector_t.
+//
+typedef struct
+{
+    fixed_t	floorheight;
+    fixed_t	ceilingheight;
+    short	floorpic;
+    short	ceilingpic;
+    short	lightlevel;
+
+    // things[firstthing] on, in thinglist order
+    short	numthings;
+    int		firstthing;
+
+    // R_AddSprites has been here on this frame
+    int		validcount;
+
+} snapsector_t;
+
+
+//
+// A sidedef, switches and scrollers change these.
+//
+typedef struct
+{
+    fixed_t	textureoffset;
+    fixed_t	rowoffset;
+    short	toptexture;
+    short	bottomtexture;
+    short	midtexture;
+
+} snapside_t;
+
+
+//
+// A thing, with where it was a tic ago for -interpolate.
+//
+typedef struct
+{
+    fixed_t	x;
+    fixed_t	y;
+    fixed_t	z;
+    fixed_t	oldx;
+    fixed_t	oldy;
+    fixed_t	oldz;
+    angle_t	angle;
+    angle_t	oldangle;
+    spritenum_t	sprite;
+    int		frame;
+    int		flags;
+
+} snapthing_t;
+
+
+//
+// A weapon sprite, sprite -1 when off.
+//
+typedef struct
+{
+    int		sprite;
+    int		frame;
+    fixed_t	sx;
+    fixed_t	sy;
+
+} snappsp_t;
+
+
+//
+// The view of displayplayer.
+//
+typedef struct
+{
+    fixed_t	x;
+    fixed_t	y;
+    fixed_t	oldx;
+    fixed_t	oldy;
+    angle_t	angle;
+    angle_t	oldangle;
+    fixed_t	viewz;
+    fixed_t	oldviewz;
+
+    // false on the first tic of a level
+    boolean	lerpviewz;
+
+    int		extralight;
+    int		fixedcolormap;
+
+    // partial invisibility, the weapon draws as a shadow
+    boolean	shadow;
+
+    // of the sector the player stands in, for the weapon
+    int		lightlevel;
+
+    snappsp_t	psprites[NUMPSPRITES];
+    int		skytexture;
+
+} snapview_t;
+
+
+typedef struct
+{
+    snapview_t		view;
+    snapsector_t*	sectors;
+    snapside_t*		sides;
+    snapthing_t*	things;
+    int			numthings;
+    int			maxthings;
+
+    // of the animated walls and flats
+    int*		texturetranslation;
+    int*		flattranslation;
+
+    // taken on this level
+    boolean		valid;
+
+} snapshot_t;
+
+
+// The snapshot the refresh draws.
+extern snapshot_t*	r_snap;
+
+#define R_SnapSector(sec)	(&r_snap->sectors[(sec) - sectors])
+#define R_SnapSide(side)	(&r_snap->sides[(side) - sides])
+
+// -rthread, the view is drawn on a second thread.
+extern boolean		r_threaded;
+
+
+// Called by R_Init, after R_InitData.
+void R_InitSnapshots (void);
+
+// Called by P_SetupLevel once the level is loaded.
+void R_SetupSnapshots (void);
+
+// Takes r_snap from the live level, for drawing on
+// the game thread.
+void R_TakeSnapshot (player_t* player);
+
+// Called at the end of P_Ticker under -rthread.
+void R_SnapshotTic (void);
+
+// Called by D_DoomLoop after the display, starts drawing
+// the last tic on the render thread.
+void R_StartView (void);
+
+// Waits for the render thread to finish drawing.
+void R_WaitView (void);
+
+// True once for each view the render thread drew.
+boolean R_ViewDrawn (void);
+
+// The drawn view is of no use, the view size changed.
+void R_DropView (void);
+
+
+#endif
+//-----------------------------------------------------------------------------
+//
+// $Log:$
+//
+//-----------------------------------------------------------------------------
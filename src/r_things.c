@@ -46,6 +46,9 @@ rcsid[] = "$Id: r_things.c,v 1.5 1997/02/03 16:47:56 b1 Exp $";
 #define MINZ				(FRACUNIT*4)
 #define BASEYCENTER			100
 
+// R_AddSprites marks the sectors done with it
+extern int		framecount;
+
 //void R_DrawColumn (void);
 //void R_DrawFuzzColumn (void);
 
@@ -416,7 +419,7 @@ R_DrawVisSprite
     }
     else if (vis->mobjflags & MF_TRANSLATION)
     {
-	colfunc = R_DrawTranslatedColumn;
+	colfunc = transcolfunc;
 	dc_translation = translationtables - 256 +
 	    ( (vis->mobjflags & MF_TRANSLATION) >> (MF_TRANSSHIFT-8) );
     }
@@ -449,7 +452,7 @@ R_DrawVisSprite
 // Generates a vissprite for a thing
 //  if it might be visible.
 //
-void R_ProjectSprite (mobj_t* thing)
+void R_ProjectSprite (snapthing_t* thing)
 {
     fixed_t		tr_x;
     fixed_t		tr_y;
@@ -478,10 +481,19 @@ void R_ProjectSprite (mobj_t* thing)
     
     angle_t		ang;
     fixed_t		iscale;
+
+    fixed_t		thingx;
+    fixed_t		thingy;
+    fixed_t		thingz;
+
+    // between the tics when interpolating
+    thingx = R_Lerp (thing->oldx, thing->x);
+    thingy = R_Lerp (thing->oldy, thing->y);
+    thingz = R_Lerp (thing->oldz, thing->z);
     
     // transform the origin point
-    tr_x = thing->x - viewx;
-    tr_y = thing->y - viewy;
+    tr_x = thingx - viewx;
+    tr_y = thingy - viewy;
 	
     gxt = FixedMul(tr_x,viewcos); 
     gyt = -FixedMul(tr_y,viewsin);
@@ -519,8 +531,8 @@ void R_ProjectSprite (mobj_t* thing)
     if (sprframe->rotate)
     {
 	// choose a different rotation based on player view
-	ang = R_PointToAngle (thing->x, thing->y);
-	rot = (ang-thing->angle+(unsigned)(ANG45/2)*9)>>29;
+	ang = R_PointToAngle (thingx, thingy);
+	rot = (ang-R_LerpAngle (thing->oldangle, thing->angle)+(unsigned)(ANG45/2)*9)>>29;
 	lump = sprframe->lump[rot];
 	flip = (boolean)sprframe->flip[rot];
     }
@@ -550,10 +562,10 @@ void R_ProjectSprite (mobj_t* thing)
     vis = R_NewVisSprite ();
     vis->mobjflags = thing->flags;
     vis->scale = xscale<<detailshift;
-    vis->gx = thing->x;
-    vis->gy = thing->y;
-    vis->gz = thing->z;
-    vis->gzt = thing->z + spritetopoffset[lump];
+    vis->gx = thingx;
+    vis->gy = thingy;
+    vis->gz = thingz;
+    vis->gzt = thingz + spritetopoffset[lump];
     vis->texturemid = vis->gzt - viewz;
     vis->x1 = x1 < 0 ? 0 : x1;
     vis->x2 = x2 >= viewwidth ? viewwidth-1 : x2;	
@@ -610,20 +622,21 @@ void R_ProjectSprite (mobj_t* thing)
 // R_AddSprites
 // During BSP traversal, this adds sprites by sector.
 //
-void R_AddSprites (sector_t* sec)
+void R_AddSprites (snapsector_t* sec)
 {
-    mobj_t*		thing;
+    snapthing_t*	thing;
     int			lightnum;
+    int			i;
 
     // BSP is traversed by subsector.
     // A sector might have been split into several
     //  subsectors during BSP building.
     // Thus we check whether its already added.
-    if (sec->validcount == validcount)
+    if (sec->validcount == framecount)
 	return;		
 
     // Well, now it will be done.
-    sec->validcount = validcount;
+    sec->validcount = framecount;
 	
     lightnum = (sec->lightlevel >> LIGHTSEGSHIFT)+extralight;
 
@@ -635,15 +648,16 @@ void R_AddSprites (sector_t* sec)
 	spritelights = scalelight[lightnum];
 
     // Handle all things in sector.
-    for (thing = sec->thinglist ; thing ; thing = thing->snext)
-	R_ProjectSprite (thing);
+    thing = &r_snap->things[sec->firstthing];
+    for (i=0 ; i<sec->numthings ; i++)
+	R_ProjectSprite (thing++);
 }
 
 
 //
 // R_DrawPSprite
 //
-void R_DrawPSprite (pspdef_t* psp)
+void R_DrawPSprite (snappsp_t* psp)
 {
     fixed_t		tx;
     int			x1;
@@ -657,17 +671,17 @@ void R_DrawPSprite (pspdef_t* psp)
     
     // decide which patch to use
 #ifdef RANGECHECK
-    if ( (unsigned)psp->state->sprite >= numsprites)
+    if ( (unsigned)psp->sprite >= numsprites)
 	I_Error ("R_ProjectSprite: invalid sprite number %i ",
-		 psp->state->sprite);
+		 psp->sprite);
 #endif
-    sprdef = &sprites[psp->state->sprite];
+    sprdef = &sprites[psp->sprite];
 #ifdef RANGECHECK
-    if ( (psp->state->frame & FF_FRAMEMASK)  >= sprdef->numframes)
+    if ( (psp->frame & FF_FRAMEMASK)  >= sprdef->numframes)
 	I_Error ("R_ProjectSprite: invalid sprite frame %i : %i ",
-		 psp->state->sprite, psp->state->frame);
+		 psp->sprite, psp->frame);
 #endif
-    sprframe = &sprdef->spriteframes[ psp->state->frame & FF_FRAMEMASK ];
+    sprframe = &sprdef->spriteframes[ psp->frame & FF_FRAMEMASK ];
 
     lump = sprframe->lump[0];
     flip = (boolean)sprframe->flip[0];
@@ -713,8 +727,7 @@ void R_DrawPSprite (pspdef_t* psp)
 
     vis->patch = lump;
 
-    if (viewplayer->powers[pw_invisibility] > 4*32
-	|| viewplayer->powers[pw_invisibility] & 8)
+    if (r_snap->view.shadow)
     {
 	// shadow draw
 	vis->colormap = NULL;
@@ -724,7 +737,7 @@ void R_DrawPSprite (pspdef_t* psp)
 	// fixed color
 	vis->colormap = fixedcolormap;
     }
-    else if (psp->state->frame & FF_FULLBRIGHT)
+    else if (psp->frame & FF_FULLBRIGHT)
     {
 	// full bright
 	vis->colormap = colormaps;
@@ -747,11 +760,11 @@ void R_DrawPlayerSprites (void)
 {
     int		i;
     int		lightnum;
-    pspdef_t*	psp;
+    snappsp_t*	psp;
     
     // get light level
     lightnum =
-	(viewplayer->mo->subsector->sector->lightlevel >> LIGHTSEGSHIFT) 
+	(r_snap->view.lightlevel >> LIGHTSEGSHIFT) 
 	+extralight;
 
     if (lightnum < 0)		
@@ -766,11 +779,11 @@ void R_DrawPlayerSprites (void)
     mceilingclip = negonearray;
     
     // add all active psprites
-    for (i=0, psp=viewplayer->psprites;
+    for (i=0, psp=r_snap->view.psprites;
 	 i<NUMPSPRITES;
 	 i++,psp++)
     {
-	if (psp->state)
+	if (psp->sprite != -1)
 	    R_DrawPSprite (psp);
     }
 }
@@ -23,6 +23,8 @@
 #ifndef __R_THINGS__
 #define __R_THINGS__
 
+#include "r_snap.h"
+
 
 #ifdef __GNUG__
 #pragma interface
@@ -54,7 +56,7 @@ void R_DrawMaskedColumn (column_t* column);
 
 void R_SortVisSprites (void);
 
-void R_AddSprites (sector_t* sec);
+void R_AddSprites (snapsector_t* sec);
 void R_AddPSprites (void);
 void R_DrawSprites (void);
 void R_InitSprites (char** namelist);
@@ -35,6 +35,7 @@ rcsid[] = "$Id: s_sound.c,v 1.6 1997/02/03 22:45:12 b1 Exp $";
 #include "s_sound.h"
 
 #include "z_zone.h"
+#include "m_argv.h"
 #include "m_random.h"
 #include "w_wad.h"
 
@@ -100,6 +101,9 @@ typedef struct
 
     // handle of the sound being played
     int		handle;
+
+    // volume after distance attenuation
+    int		volume;
     
 } channel_t;
 
@@ -128,6 +132,10 @@ static musicinfo_t*	mus_playing=0;
 // number of channels available
 int			numChannels;	
 
+// Vary the sfx pitches as DOOM 1.2 did. Later versions
+//  dropped it, and unpitched sounds mix faster.
+int			snd_pitchshift;
+
 static int		nextcleanup;
 
 
@@ -138,7 +146,17 @@ static int		nextcleanup;
 int
 S_getChannel
 ( void*		origin,
-  sfxinfo_t*	sfxinfo );
+  sfxinfo_t*	sfxinfo,
+  int		volume );
+
+//
+// Sounds with a better priority (lower number) and louder,
+//  that is closer, sounds are more important.
+//
+static int S_Audibility (channel_t* c)
+{
+    return (c->volume+1) * (256 - c->sfxinfo->priority);
+}
 
 
 int
@@ -166,13 +184,19 @@ void S_Init
 
   fprintf( stderr, "S_Init: default sfx volume %d\n", sfxVolume);
 
-  // Whatever these did with DMX, these are rather dummies now.
-  I_SetChannels();
-  
   S_SetSfxVolume(sfxVolume);
   // No music with Linux - another dummy.
   S_SetMusicVolume(musicVolume);
 
+  // -voices overrides snd_channels
+  i = M_CheckParm ("-voices");
+  if (i && i < myargc-1)
+    numChannels = atoi (myargv[i+1]);
+  if (numChannels < 1)
+    numChannels = 1;
+  if (numChannels > MAXVOICES)
+    numChannels = MAXVOICES;
+
   // Allocating the internal channels for mixing
   // (the maximum numer of sounds rendered
   // simultaneously) within zone memory.
@@ -182,6 +206,9 @@ void S_Init
   // Free all channels for use
   for (i=0 ; i<numChannels ; i++)
     channels[i].sfxinfo = 0;
+
+  // Whatever these did with DMX, these are rather dummies now.
+  I_SetChannels();
   
   // no sounds are playing, and they are not mus_paused
   mus_paused = 0;
@@ -324,7 +351,8 @@ S_StartSoundAtVolume
   }
   
   // hacks to vary the sfx pitches
-  if (sfx_id >= sfx_sawup
+  if (snd_pitchshift
+      && sfx_id >= sfx_sawup
       && sfx_id <= sfx_sawhit)
   {	
     pitch += 8 - (M_Random()&15);
@@ -334,7 +362,8 @@ S_StartSoundAtVolume
     else if (pitch>255)
       pitch = 255;
   }
-  else if (sfx_id != sfx_itemup
+  else if (snd_pitchshift
+	   && sfx_id != sfx_itemup
 	   && sfx_id != sfx_tink)
   {
     pitch += 16 - (M_Random()&31);
@@ -349,7 +378,7 @@ S_StartSoundAtVolume
   S_StopSound(origin);
 
   // try to find a channel
-  cnum = S_getChannel(origin, sfx);
+  cnum = S_getChannel(origin, sfx, volume);
   
   if (cnum<0)
     return;
@@ -388,6 +417,7 @@ S_StartSoundAtVolume
   // Assigns the handle to one of the channels in the
   //  mix/output buffer.
   channels[cnum].handle = I_StartSound(sfx_id,
+				       cnum,
 				       /*sfx->data,*/
 				       volume,
 				       sep,
@@ -493,10 +523,12 @@ void S_StopSound(void *origin)
 
 
 //
-// Stop and resume music, during game PAUSE.
+// Stop and resume music and sound effects, during game PAUSE.
 //
 void S_PauseSound(void)
 {
+    I_PauseSound();
+
     if (mus_playing && !mus_paused)
     {
 	I_PauseSong(mus_playing->handle);
@@ -506,6 +538,8 @@ void S_PauseSound(void)
 
 void S_ResumeSound(void)
 {
+    I_ResumeSound();
+
     if (mus_playing && mus_paused)
     {
 	I_ResumeSong(mus_playing->handle);
@@ -595,7 +629,10 @@ void S_UpdateSounds(void* listener_p)
 			S_StopChannel(cnum);
 		    }
 		    else
+		    {
+			c->volume = volume;
 			I_UpdateSoundParams(c->handle, volume, sep, pitch);
+		    }
 		}
 	    }
 	    else
@@ -828,10 +865,13 @@ S_AdjustSoundParams
 int
 S_getChannel
 ( void*		origin,
-  sfxinfo_t*	sfxinfo )
+  sfxinfo_t*	sfxinfo,
+  int		volume )
 {
     // channel number to use
     int		cnum;
+    int		audibility;
+    int		least;
     
     channel_t*	c;
 
@@ -850,20 +890,25 @@ S_getChannel
     // None available
     if (cnum == numChannels)
     {
-	// Look for lower priority
-	for (cnum=0 ; cnum<numChannels ; cnum++)
-	    if (channels[cnum].sfxinfo->priority >= sfxinfo->priority) break;
+	// Look for the least audible sound, by priority
+	//  and by volume, that is distance
+	least = 0;
+	for (cnum=1 ; cnum<numChannels ; cnum++)
+	    if (S_Audibility(&channels[cnum]) < S_Audibility(&channels[least]))
+		least = cnum;
 
-	if (cnum == numChannels)
+	c = &channels[least];
+	audibility = (volume+1) * (256 - sfxinfo->priority);
+
+	if (S_Audibility(c) > audibility)
 	{
-	    // FUCK!  No lower priority.  Sorry, Charlie.    
+	    // Everything playing is more important.
 	    return -1;
 	}
-	else
-	{
-	    // Otherwise, kick out lower priority.
-	    S_StopChannel(cnum);
-	}
+
+	// Otherwise, kick out the least audible.
+	S_StopChannel(least);
+	cnum = least;
     }
 
     c = &channels[cnum];
@@ -871,10 +916,10 @@ S_getChannel
     // channel is decided to be cnum.
     c->sfxinfo = sfxinfo;
     c->origin = origin;
+    c->volume = volume;
 
     return cnum;
 }
 
 
 
-
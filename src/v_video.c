@@ -45,6 +45,14 @@ byte*				screens[5];
  
 int				dirtybox[4]; 
 
+dirtyrect_t			dirtyrects[MAXDIRTYRECTS];
+int				numdirtyrects;
+
+// Two regions are merged when their bounding rect wastes
+// less than this many pixels, as every separate rect costs
+// the driver an address window setup.
+#define DIRTYSLOP		(8*SCREENWIDTH)
+
 
 
 // Now where did these came from?
@@ -139,6 +147,23 @@ int	usegamma;
 //
 // V_MarkRect 
 // 
+static int V_RectArea (dirtyrect_t* r)
+{
+    return (r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+static void V_UnionRect (dirtyrect_t* dest, dirtyrect_t* r)
+{
+    if (r->x1 < dest->x1)
+	dest->x1 = r->x1;
+    if (r->y1 < dest->y1)
+	dest->y1 = r->y1;
+    if (r->x2 > dest->x2)
+	dest->x2 = r->x2;
+    if (r->y2 > dest->y2)
+	dest->y2 = r->y2;
+}
+
 void
 V_MarkRect
 ( int		x,
@@ -146,9 +171,92 @@ V_MarkRect
   int		width,
   int		height ) 
 { 
+    dirtyrect_t	r;
+    dirtyrect_t	u;
+    int		i;
+    int		best;
+    int		bestwaste;
+    int		waste;
+
     M_AddToBox (dirtybox, x, y); 
     M_AddToBox (dirtybox, x+width-1, y+height-1); 
+
+    // clip to the screen
+    r.x1 = x < 0 ? 0 : x;
+    r.y1 = y < 0 ? 0 : y;
+    r.x2 = x+width > SCREENWIDTH ? SCREENWIDTH-1 : x+width-1;
+    r.y2 = y+height > SCREENHEIGHT ? SCREENHEIGHT-1 : y+height-1;
+
+    if (r.x1 > r.x2 || r.y1 > r.y2)
+	return;
+
+    // Merge with every region that is close enough,
+    //  growing the new one until nothing else fits.
+    i = 0;
+    while (i < numdirtyrects)
+    {
+	u = r;
+	V_UnionRect (&u, &dirtyrects[i]);
+
+	if (V_RectArea (&u) <= V_RectArea (&r)
+	    + V_RectArea (&dirtyrects[i]) + DIRTYSLOP)
+	{
+	    r = u;
+	    dirtyrects[i] = dirtyrects[--numdirtyrects];
+	    i = 0;
+	}
+	else
+	    i++;
+    }
+
+    // Out of slots, fold into the region that wastes least.
+    while (numdirtyrects == MAXDIRTYRECTS)
+    {
+	best = 0;
+	bestwaste = MAXINT;
+	for (i=0 ; i<numdirtyrects ; i++)
+	{
+	    u = r;
+	    V_UnionRect (&u, &dirtyrects[i]);
+	    waste = V_RectArea (&u) - V_RectArea (&dirtyrects[i]);
+	    if (waste < bestwaste)
+	    {
+		best = i;
+		bestwaste = waste;
+	    }
+	}
+	V_UnionRect (&r, &dirtyrects[best]);
+	dirtyrects[best] = dirtyrects[--numdirtyrects];
+    }
+
+    dirtyrects[numdirtyrects++] = r;
 } 
+
+
+//
+// V_ClearDirtyRects
+//
+void V_ClearDirtyRects (void)
+{
+    numdirtyrects = 0;
+    M_ClearBox (dirtybox);
+}
+
+
+//
+// V_DirtyArea
+//
+int V_DirtyArea (void)
+{
+    int		i;
+    int		area;
+
+    area = 0;
+    for (i=0 ; i<numdirtyrects ; i++)
+	area += V_RectArea (&dirtyrects[i]);
+
+    return area;
+}
  
 
 //
@@ -490,4 +598,6 @@ void V_Init (void)
 
     for (i=0 ; i<4 ; i++)
 	screens[i] = base + i*SCREENWIDTH*SCREENHEIGHT;
+
+    V_ClearDirtyRects ();
 }
@@ -48,6 +48,21 @@ extern	byte*		screens[5];
 
 extern  int	dirtybox[4];
 
+// Regions of screen 0 changed since the last I_FinishUpdate,
+// inclusive pixel coordinates. Fed by V_MarkRect, consumed
+// by the video driver to send only what changed.
+typedef struct
+{
+    int		x1, y1;
+    int		x2, y2;
+
+} dirtyrect_t;
+
+#define MAXDIRTYRECTS		16
+
+extern	dirtyrect_t	dirtyrects[MAXDIRTYRECTS];
+extern	int		numdirtyrects;
+
 extern	byte	gammatable[5][256];
 extern	int	usegamma;
 
@@ -111,6 +126,12 @@ V_MarkRect
   int		width,
   int		height );
 
+// Called by the video driver once the dirty regions are on the display.
+void V_ClearDirtyRects (void);
+
+// Number of pixels covered by the current dirty regions.
+int V_DirtyArea (void);
+
 #endif
 //-----------------------------------------------------------------------------
 //
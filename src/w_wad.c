@@ -453,8 +453,11 @@ W_ReadLump
     else
 	handle = l->handle;
 		
+    // one file position for all the threads
+    Z_Lock ();
     lseek (handle, l->position, SEEK_SET);
     c = read (handle, dest, l->size);
+    Z_Unlock ();
 
     if (c < l->size)
 	I_Error ("W_ReadLump: only read %i of %i on lump %i",
@@ -482,6 +485,7 @@ W_CacheLumpNum
     if ((unsigned)lump >= numlumps)
 	I_Error ("W_CacheLumpNum: %i >= numlumps",lump);
 		
+    Z_Lock ();
     if (!lumpcache[lump])
     {
 	// read the lump in
@@ -495,8 +499,10 @@ W_CacheLumpNum
 	//printf ("cache hit on lump %i\n",lump);
 	Z_ChangeTag (lumpcache[lump],tag);
     }
+    ptr = lumpcache[lump];
+    Z_Unlock ();
 	
-    return lumpcache[lump];
+    return ptr;
 }
 
 
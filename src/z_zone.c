@@ -24,6 +24,8 @@
 static const char
 rcsid[] = "$Id: z_zone.c,v 1.4 1997/02/03 16:47:58 b1 Exp $";
 
+#include <pthread.h>
+
 #include "z_zone.h"
 #include "i_system.h"
 #include "doomdef.h"
@@ -60,6 +62,79 @@ typedef struct
 memzone_t*	mainzone;
 
 
+//
+// With -rthread the renderer caches textures and sprites
+//  while the game thread runs the tics. One lock covers the
+//  zone and the lump cache, the thread holding it may take
+//  it again. Z_Init makes it recursive.
+//
+static pthread_mutex_t	zonelock;
+
+// Times the holder took the lock, for Z_WaitPurge.
+//  Only the holder touches it.
+static int		zonedepth;
+
+// Z_HoldPurge
+static pthread_t	purgeholder;
+static void		(*purgewait) (void);
+
+
+void Z_Lock (void)
+{
+    pthread_mutex_lock (&zonelock);
+    zonedepth++;
+}
+
+void Z_Unlock (void)
+{
+    zonedepth--;
+    pthread_mutex_unlock (&zonelock);
+}
+
+
+//
+// Z_HoldPurge
+// The calling thread draws from purgable blocks. Until it
+//  passes NULL, Z_Malloc on other threads leaves those blocks
+//  alone, and calls wait when it cannot do without them.
+//
+void Z_HoldPurge (void (*wait) (void))
+{
+    Z_Lock ();
+    purgeholder = pthread_self ();
+    purgewait = wait;
+    Z_Unlock ();
+}
+
+static boolean Z_PurgeHeld (void)
+{
+    return purgewait && !pthread_equal (purgeholder, pthread_self ());
+}
+
+//
+// Z_WaitPurge
+// Lets go of the lock entirely while the holder finishes.
+//
+static void Z_WaitPurge (void)
+{
+    void	(*wait) (void);
+    int		depth;
+    int		i;
+
+    wait = purgewait;
+    depth = zonedepth;
+    zonedepth = 0;
+    for (i=0 ; i<depth ; i++)
+	pthread_mutex_unlock (&zonelock);
+
+    wait ();
+
+    for (i=0 ; i<depth ; i++)
+	pthread_mutex_lock (&zonelock);
+    zonedepth = depth;
+}
+
+
 
 //
 // Z_ClearZone
@@ -94,6 +169,12 @@ void Z_Init (void)
 {
     memblock_t*	block;
     int		size;
+    pthread_mutexattr_t	attr;
+
+    pthread_mutexattr_init (&attr);
+    pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init (&zonelock, &attr);
+    pthread_mutexattr_destroy (&attr);
 
     mainzone = (memzone_t *)I_ZoneBase (&size);
     mainzone->size = size;
@@ -124,6 +205,7 @@ void Z_Free (void* ptr)
     memblock_t*		block;
     memblock_t*		other;
 	
+    Z_Lock ();
     block = (memblock_t *) ( (byte *)ptr - sizeof(memblock_t));
 
     if (block->id != ZONEID)
@@ -169,6 +251,7 @@ void Z_Free (void* ptr)
 	if (other == mainzone->rover)
 	    mainzone->rover = block;
     }
+    Z_Unlock ();
 }
 
 
@@ -202,6 +285,8 @@ Z_Malloc
     // account for size of block header
     size += sizeof(memblock_t);
     
+    Z_Lock ();
+  retry:
     // if there is a free block behind the rover,
     //  back up over them
     base = mainzone->rover;
@@ -216,13 +301,20 @@ Z_Malloc
     {
 	if (rover == start)
 	{
+	    // nothing left but what another thread draws from
+	    if (Z_PurgeHeld ())
+	    {
+		Z_WaitPurge ();
+		goto retry;
+	    }
+
 	    // scanned all the way around the list
 	    I_Error ("Z_Malloc: failed on allocation of %i bytes", size);
 	}
 	
 	if (rover->user)
 	{
-	    if (rover->tag < PU_PURGELEVEL)
+	    if (rover->tag < PU_PURGELEVEL || Z_PurgeHeld ())
 	    {
 		// hit a block that can't be purged,
 		//  so move base past it
@@ -284,6 +376,7 @@ Z_Malloc
     mainzone->rover = base->next;	
 	
     base->id = ZONEID;
+    Z_Unlock ();
     
     return (void *) ((byte *)base + sizeof(memblock_t));
 }
@@ -301,6 +394,7 @@ Z_FreeTags
     memblock_t*	block;
     memblock_t*	next;
 	
+    Z_Lock ();
     for (block = mainzone->blocklist.next ;
 	 block != &mainzone->blocklist ;
 	 block = next)
@@ -315,6 +409,7 @@ Z_FreeTags
 	if (block->tag >= lowtag && block->tag <= hightag)
 	    Z_Free ( (byte *)block+sizeof(memblock_t));
     }
+    Z_Unlock ();
 }
 
 
@@ -440,7 +535,9 @@ Z_ChangeTag2
     if (tag >= PU_PURGELEVEL && (unsigned)block->user < 0x100)
 	I_Error ("Z_ChangeTag: an owner is required for purgable blocks");
 
+    Z_Lock ();
     block->tag = tag;
+    Z_Unlock ();
 }
 
 
@@ -455,6 +552,7 @@ int Z_FreeMemory (void)
 	
     free = 0;
     
+    Z_Lock ();
     for (block = mainzone->blocklist.next ;
 	 block != &mainzone->blocklist;
 	 block = block->next)
@@ -462,6 +560,7 @@ int Z_FreeMemory (void)
 	if (!block->user || block->tag >= PU_PURGELEVEL)
 	    free += block->size;
     }
+    Z_Unlock ();
     return free;
 }
 
@@ -54,6 +54,11 @@ void    Z_CheckHeap (void);
 void    Z_ChangeTag2 (void *ptr, int tag);
 int     Z_FreeMemory (void);
 
+// For threads sharing the zone and the lump cache.
+void	Z_Lock (void);
+void	Z_Unlock (void);
+void	Z_HoldPurge (void (*wait) (void));
+
 
 typedef struct memblock_s
 {